@@ -62,8 +62,10 @@ void UTextureSet::AugmentMaterialTextureParameters(const FCustomParameterValue&
 	if (!IsValid(Definition))
 		return;
 
+	const UTextureSetDerivedData* MaterialDerivedData = GetMaterialDerivedData();
+
 #if WITH_EDITOR
-	if (!DerivedData)
+	if (!MaterialDerivedData)
 	{
 		if (FApp::CanEverRender())
 		{
@@ -78,20 +80,21 @@ void UTextureSet::AugmentMaterialTextureParameters(const FCustomParameterValue&
 		{
 			// Likely we're in a commandlet and cooking, so wait until we have valid derived data
 			((UTextureSet*)this)->UpdateDerivedData(false);
+			MaterialDerivedData = DerivedData.Get();
 		}
 	}
 #endif
 
-	check(DerivedData);
+	check(MaterialDerivedData);
 
-	TextureParameters.Reserve(TextureParameters.Num() + DerivedData->Textures.Num());
-	for (int i = 0; i < DerivedData->Textures.Num(); i++)
+	TextureParameters.Reserve(TextureParameters.Num() + MaterialDerivedData->Textures.Num());
+	for (int i = 0; i < MaterialDerivedData->Textures.Num(); i++)
 	{
-		const FDerivedTextureData& DerivedTextureData = DerivedData->Textures[i].Data;
+		const FDerivedTextureData& DerivedTextureData = MaterialDerivedData->Textures[i].Data;
 
 		// Set the texture parameter for each packed texture
 		FTextureParameterValue TextureParameter;
-		TextureParameter.ParameterValue = DerivedData->Textures[i].Texture;
+		TextureParameter.ParameterValue = MaterialDerivedData->Textures[i].Texture;
 		TextureParameter.ParameterInfo.Name = TextureSetsHelpers::MakeTextureParameterName(CustomParameter.ParameterInfo.Name, i);
 		TextureParameter.ParameterInfo.Association = CustomParameter.ParameterInfo.Association;
 		TextureParameter.ParameterInfo.Index = CustomParameter.ParameterInfo.Index;
@@ -104,8 +107,10 @@ void UTextureSet::AugmentMaterialVectorParameters(const FCustomParameterValue& C
 	if (!IsValid(Definition))
 		return;
 
+	const UTextureSetDerivedData* MaterialDerivedData = GetMaterialDerivedData();
+
 #if WITH_EDITOR
-	if (!DerivedData)
+	if (!MaterialDerivedData)
 	{
 		if (FApp::CanEverRender())
 		{
@@ -120,14 +125,15 @@ void UTextureSet::AugmentMaterialVectorParameters(const FCustomParameterValue& C
 		{
 			// Likely we're in a commandlet and cooking, so wait until we have valid derived data
 			((UTextureSet*)this)->UpdateDerivedData(false);
+			MaterialDerivedData = DerivedData.Get();
 		}
 	}
 #endif
 
-	check(DerivedData);
+	check(MaterialDerivedData);
 
 	// Set any constant parameters what we have
-	for (const auto& [ParameterName, Data] : DerivedData->MaterialParameters)
+	for (const auto& [ParameterName, Data] : MaterialDerivedData->MaterialParameters)
 	{
 		FVectorParameterValue Parameter;
 		Parameter.ParameterValue = FLinearColor(Data.Value);
@@ -137,9 +143,9 @@ void UTextureSet::AugmentMaterialVectorParameters(const FCustomParameterValue& C
 		VectorParameters.Add(Parameter);
 	}
 
-	for (int i = 0; i < DerivedData->Textures.Num(); i++)
+	for (int i = 0; i < MaterialDerivedData->Textures.Num(); i++)
 	{
-		const FDerivedTextureData& DerivedTextureData = DerivedData->Textures[i].Data;
+		const FDerivedTextureData& DerivedTextureData = MaterialDerivedData->Textures[i].Data;
 
 		// Set any constant parameters that come with this texture
 		for (auto& [ParameterName, Value] : DerivedTextureData.TextureParameters)
@@ -165,7 +171,9 @@ void UTextureSet::Serialize(FArchive& Ar)
 	if (bSerializeDerivedData)
 	{
 		if (Ar.IsCooking() && Ar.IsSaving())
+		{
 			check(DerivedData);
+		}
 		
 		Ar << DerivedData;
 
@@ -385,10 +393,23 @@ void UTextureSet::UpdateDerivedData(bool bAllowAsync, bool bStartImmediately)
 }
 #endif
 
+const UTextureSetDerivedData* UTextureSet::GetMaterialDerivedData() const
+{
+#if WITH_EDITORONLY_DATA
+	// Materials show the low resolution preview, if there is one, until the full resolution data is assigned
+	if (!DerivedData)
+		return PreviewDerivedData.Get();
+#endif
+
+	return DerivedData.Get();
+}
+
 const UTextureSetDerivedData* UTextureSet::GetDerivedData() const
 {
 	#if WITH_EDITOR
 	// If called in the editor it's possible we haven't updated our derived data yet, so stall here until we do.
+	// Anything still in flight gets the highest priority while we wait on it.
+	FTextureSetCompilingManager::Get().RequestPriority(this, ETextureSetCompilePriority::Stalled);
 	((UTextureSet*)this)->UpdateDerivedData(false, true);
 	#endif
 
@@ -7,10 +7,16 @@
 #if WITH_EDITOR
 #include "AssetCompilingManager.h"
 #include "AsyncCompilationHelpers.h"
+#include "Components/PrimitiveComponent.h"
+#include "Editor.h"
 #include "EditorSupportDelegates.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
 #include "Misc/QueuedThreadPoolWrapper.h"
 #include "ObjectCacheContext.h"
 #include "ProfilingDebugging/CountersTrace.h"
+#include "Subsystems/AssetEditorSubsystem.h"
 #include "TextureSet.h"
 #include "TextureSetCompiler.h"
 #include "TextureSetDefinition.h"
@@ -32,11 +38,110 @@ static AsyncCompilationHelpers::FAsyncCompilationStandardCVars CVarAsyncTextureS
 static TAutoConsoleVariable<int> CVarMaxAsyncTextureSetParallelCompiles(
 	TEXT("ts.MaxAsyncTextureSetParallelCompiles"),
 	32,
-	TEXT("Maximum number of async texture set compilations. Mainly used to limit memory usage"));
-
+	TEXT("Maximum number of async texture set compilations. Concurrency is otherwise limited by the estimated memory of each compilation"));
+
+static TAutoConsoleVariable<float> CVarCompilationMemoryEstimateScale(
+	TEXT("ts.CompilationMemoryEstimateScale"),
+	1.0f,
+	TEXT("Scale applied to the estimated peak memory of each texture set compilation when admitting queued compilations.\n")
+	TEXT("Raise it if compilations are running out of memory, or lower it to allow more to run in parallel."));
+
+static TAutoConsoleVariable<int32> CVarPreviewSize(
+	TEXT("ts.PreviewSize"),
+	512,
+	TEXT("Largest width or height of the low resolution preview compiled ahead of texture sets more than twice this size,\n")
+	TEXT("so they don't show their definition's default texture set while they compile. 0 to disable."));
+
+
+static TAutoConsoleVariable<float> CVarQueueAgingSeconds(
+	TEXT("ts.QueueAgingSeconds"),
+	30.0f,
+	TEXT("Time a texture set waits in the compilation queue to gain one level of priority, so low priority texture sets aren't starved.\n")
+	TEXT("0 disables aging, so texture sets only compile in order of priority and then in the order they were queued."));
+
+static TAutoConsoleVariable<float> CVarQueuePriorityRefreshSeconds(
+	TEXT("ts.QueuePriorityRefreshSeconds"),
+	1.0f,
+	TEXT("Interval at which the priority hints of queued and in flight texture set compilations are refreshed,\n")
+	TEXT("from the assets open in editors and the texture sets used by primitives recently rendered in the world."));
+
+static TAutoConsoleVariable<int32> CVarQueuePriorityActorsPerTick(
+	TEXT("ts.QueuePriorityActorsPerTick"),
+	256,
+	TEXT("Most actors visited per tick when gathering the texture sets used by primitives in the world for priority hints.
+")
+	TEXT("A refresh takes as many ticks as it needs to visit every actor of the editor and PIE worlds."));
 
 namespace TextureSetCompilingManagerImpl
 {
+	static EQueuedWorkPriority ToQueuedWorkPriority(ETextureSetCompilePriority Priority)
+	{
+		switch (Priority)
+		{
+		case ETextureSetCompilePriority::Stalled: return EQueuedWorkPriority::Blocking;
+		case ETextureSetCompilePriority::Editing: return EQueuedWorkPriority::Highest;
+		case ETextureSetCompilePriority::Visible: return EQueuedWorkPriority::High;
+		default: return EQueuedWorkPriority::Normal;
+		}
+	}
+
+	class FCompilableTextureSet final : public AsyncCompilationHelpers::ICompilable
+	{
+	public:
+		FCompilableTextureSet(UTextureSet* TextureSet, TSharedPtr<TextureSetCompilerTask> Task)
+			: TextureSet(TextureSet)
+			, Task(Task)
+		{}
+
+		virtual void Reschedule(FQueuedThreadPool* InThreadPool, EQueuedWorkPriority InPriority) override final
+		{
+			Task->SetPriority(InPriority);
+		}
+
+		virtual bool WaitCompletionWithTimeout(float TimeLimitSeconds) override final
+		{
+			return Task->TryFinalize();
+		}
+
+		virtual FName GetName() override final { return  TextureSet->GetFName(); }
+
+		TStrongObjectPtr<UTextureSet> TextureSet;
+		TSharedPtr<TextureSetCompilerTask> Task;
+	};
+
+	// Adds the texture sets assigned in a material instance, its parents and its layers
+	static void CollectTextureSets(const UMaterialInterface* Material, TSet<const UMaterialInterface*>& VisitedMaterials, TSet<TWeakObjectPtr<const UTextureSet>>& OutTextureSets)
+	{
+		for (const UMaterialInstance* Instance = Cast<UMaterialInstance>(Material); IsValid(Instance); Instance = Cast<UMaterialInstance>(Instance->Parent))
+		{
+			bool bAlreadyVisited = false;
+			VisitedMaterials.Add(Instance, &bAlreadyVisited);
+			if (bAlreadyVisited)
+				break;
+
+			for (const FCustomParameterValue& Param : Instance->CustomParameterValues)
+			{
+				if (const UTextureSet* TextureSet = Cast<UTextureSet>(Param.ParameterValue))
+					OutTextureSets.Add(TextureSet);
+			}
+
+			FMaterialLayersFunctions Functions;
+			if (Instance->GetMaterialLayers(Functions))
+			{
+				for (const TObjectPtr<UMaterialFunctionInterface>& Layer : Functions.GetRuntime().Layers)
+				{
+					if (const UMaterialFunctionInstance* LayerInstance = Cast<UMaterialFunctionInstance>(Layer))
+					{
+						for (const FCustomParameterValue& Param : LayerInstance->CustomParameterValues)
+						{
+							if (const UTextureSet* TextureSet = Cast<UTextureSet>(Param.ParameterValue))
+								OutTextureSets.Add(TextureSet);
+						}
+					}
+				}
+			}
+		}
+	}
 	static void EnsureInitializedCVars()
 	{
 		static bool bIsInitialized = false;
@@ -151,9 +256,20 @@ void FTextureSetCompilingManager::Shutdown()
 		// Wait on texture sets already in progress we couldn't cancel
 		FinishCompilation(PendingTextureSets);
 	}
+
+	TArray<UTextureSet*> PreviewedTextureSets;
+	PreviewTasks.GetKeys(PreviewedTextureSets);
+	for (UTextureSet* TextureSet : PreviewedTextureSets)
+		DiscardPreviewCompilation(TextureSet);
+
+	// Cancelled work still references its derived data, so it has to wind down before shutting down
+	for (const TSharedPtr<TextureSetCompilerTask>& Task : CancelledTasks)
+		Task->WaitUntilDone();
+	CancelledTasks.Empty();
 }
 
 TRACE_DECLARE_INT_COUNTER(QueuedTextureSetCompilation, TEXT("AsyncCompilation/QueuedTextureSets"));
+TRACE_DECLARE_MEMORY_COUNTER(TextureSetCompilationEstimatedMemory, TEXT("AsyncCompilation/TextureSetEstimatedMemory"));
 void FTextureSetCompilingManager::UpdateCompilationNotification()
 {
 	TRACE_COUNTER_SET(QueuedTextureSetCompilation, GetNumRemainingAssets());
@@ -178,24 +294,36 @@ void FTextureSetCompilingManager::QueueCompilation(UTextureSet* const InTextureS
 {
 	check(!InTextureSet->IsDefaultTextureSet());
 
-	QueuedTextureSets.Add(InTextureSet);
+	// Requeueing keeps the original queue time, so a texture set that keeps changing still ages
+	if (!QueuedTextureSets.Contains(InTextureSet))
+	{
+		QueuedTextureSets.Add(InTextureSet, FQueuedTextureSet{FPlatformTime::Seconds(), GetPriority(InTextureSet), 0});
+		PushQueueEntry(InTextureSet);
+	}
+
+	// The texture set has changed since its memory was estimated, if it was already queued
+	QueuedTextureSets.FindChecked(InTextureSet).EstimatedMemory = -1;
 
-	// Swap out material instances with default values until compiling has finished
-	if (InTextureSet->DerivedData != nullptr)
+	// Swap out material instances with default values until compiling has finished. Any preview is of the old data.
+	if (InTextureSet->DerivedData != nullptr || InTextureSet->PreviewDerivedData != nullptr)
 	{
 		InTextureSet->DerivedData = nullptr;
+		InTextureSet->PreviewDerivedData = nullptr;
 		NotifyMaterialInstances({InTextureSet});
 	}
 }
 
 void FTextureSetCompilingManager::StartCompilation(UTextureSet* const TextureSet, bool bAsync)
+{
+	StartCompilation(TextureSet, MakeShared<FTextureSetCompiler>(MakeCompilerArgs(TextureSet)), bAsync);
+}
+
+void FTextureSetCompilingManager::StartCompilation(UTextureSet* const TextureSet, TSharedRef<FTextureSetCompiler> Compiler, bool bAsync)
 {
 	TRACE_CPUPROFILER_EVENT_SCOPE(FTextureSetCompilingManager::StartCompilation)
 	check(IsInGameThread());
 
 	QueuedTextureSets.Remove(TextureSet);
-
-	TSharedRef<FTextureSetCompiler> Compiler = MakeShared<FTextureSetCompiler>(MakeCompilerArgs(TextureSet));
 	TSharedPtr<TextureSetCompilerTask>* ExistingTask = AsyncCompilationTasks.Find(TextureSet);
 
 	if (ExistingTask)
@@ -236,14 +364,16 @@ void FTextureSetCompilingManager::StartCompilation(UTextureSet* const TextureSet
 		{
 			UE_LOG(LogTextureSet, Verbose, TEXT("%s: starting async compilation"), *TextureSet->GetName());
 
-			Task->StartAsync(GetThreadPool(), EQueuedWorkPriority::Normal);
+			Task->StartAsync(GetThreadPool(), TextureSetCompilingManagerImpl::ToQueuedWorkPriority(GetPriority(TextureSet)));
 
 			AsyncCompilationTasks.Add(TextureSet, Task);
+			StartPreviewCompilation(TextureSet, Compiler);
 
-			// Swap out material instances with default values until compiling has finished
-			if (TextureSet->DerivedData != nullptr)
+			// Swap out material instances with default values until compiling has finished. Any preview is of the old data.
+			if (TextureSet->DerivedData != nullptr || TextureSet->PreviewDerivedData != nullptr)
 			{
 				TextureSet->DerivedData = nullptr;
+				TextureSet->PreviewDerivedData = nullptr;
 				NotifyMaterialInstances({TextureSet});
 			}
 		}
@@ -257,6 +387,11 @@ void FTextureSetCompilingManager::StartCompilation(UTextureSet* const TextureSet
 			UE_LOG(LogTextureSet, Log, TEXT("%s: compiled"), *TextureSet->GetName());
 		}
 	}
+	else
+	{
+		// Already up to date, so AssignDerivedData won't run to drop the request
+		RequestedPriorities.Remove(TextureSet);
+	}
 
 	TRACE_COUNTER_SET(QueuedTextureSetCompilation, GetNumRemainingAssets());
 }
@@ -267,29 +402,7 @@ void FTextureSetCompilingManager::FinishCompilation(TArrayView<UTextureSet* cons
 
 	check(IsInGameThread());
 
-	class FCompilableTextureSet final : public AsyncCompilationHelpers::ICompilable
-	{
-	public:
-		FCompilableTextureSet(UTextureSet* TextureSet, TSharedPtr<TextureSetCompilerTask> Task)
-			: TextureSet(TextureSet)
-			, Task(Task)
-		{}
-
-		virtual void Reschedule(FQueuedThreadPool* InThreadPool, EQueuedWorkPriority InPriority) override final
-		{
-			Task->SetPriority(InPriority);
-		}
-
-		virtual bool WaitCompletionWithTimeout(float TimeLimitSeconds) override final
-		{
-			return Task->TryFinalize();
-		}
-
-		virtual FName GetName() override final { return  TextureSet->GetFName(); }
-
-		TStrongObjectPtr<UTextureSet> TextureSet;
-		TSharedPtr<TextureSetCompilerTask> Task;
-	};
+	using TextureSetCompilingManagerImpl::FCompilableTextureSet;
 
 	TArray<FCompilableTextureSet> CompilableTextures;
 	CompilableTextures.Reserve(InTextureSets.Num());
@@ -298,6 +411,7 @@ void FTextureSetCompilingManager::FinishCompilation(TArrayView<UTextureSet* cons
 	{
 		check(AsyncCompilationTasks.Contains(TextureSet));
 		CompilableTextures.Add(FCompilableTextureSet(TextureSet, AsyncCompilationTasks.FindAndRemoveChecked(TextureSet)));
+		DiscardPreviewCompilation(TextureSet);
 	}
 
 	if (CompilableTextures.Num() > 0)
@@ -331,18 +445,75 @@ bool FTextureSetCompilingManager::TryCancelCompilation(UTextureSet* const Textur
 
 	TSharedPtr<TextureSetCompilerTask> Task = AsyncCompilationTasks.FindChecked(TextureSet);
 
+	DiscardPreviewCompilation(TextureSet);
+
 	if (Task->Cancel())
 	{
 		AsyncCompilationTasks.Remove(TextureSet);
 		UE_LOG(LogTextureSet, Log, TEXT("%s: cancelled compilation"), *TextureSet->GetName());
 		return true;
 	}
+	else if (!Task->IsWorkDone())
+	{
+		// Already running, so ask it to stop between tiles and let it wind down in the background.
+		// The texture set is free to start its replacement straight away.
+		Task->RequestCancel();
+		CancelledTasks.Add(Task);
+		AsyncCompilationTasks.Remove(TextureSet);
+		UE_LOG(LogTextureSet, Log, TEXT("%s: cancelled running compilation"), *TextureSet->GetName());
+		return true;
+	}
 	else
 	{
+		// Only the texture builds are left, which are quicker to finish than to throw away
 		return false;
 	}
 }
 
+void FTextureSetCompilingManager::StartPreviewCompilation(UTextureSet* const TextureSet, const TSharedRef<FTextureSetCompiler>& Compiler)
+{
+	check(IsInGameThread());
+	check(!PreviewTasks.Contains(TextureSet));
+
+	const int32 PreviewSize = CVarPreviewSize.GetValueOnGameThread();
+
+	// Previews are only for looking at, so they're never compiled where they could end up cooked
+	if (PreviewSize <= 0 || !FApp::CanEverRender() || IsRunningCommandlet())
+		return;
+
+	int32 MaxSize = 0;
+	for (int t = 0; t < Compiler->Args->PackingInfo.NumPackedTextures(); t++)
+	{
+		const FIntVector3 Size = Compiler->GetTextureSourceSize(t);
+		MaxSize = FMath::Max3(MaxSize, Size.X, Size.Y);
+	}
+
+	// Not worth a second compilation unless the preview is much quicker
+	if (MaxSize <= PreviewSize * 2)
+		return;
+
+	TSharedRef<FTextureSetCompilerArgs> PreviewArgs = MakeShared<FTextureSetCompilerArgs>(*Compiler->Args);
+	PreviewArgs->PreviewMaxSize = PreviewSize;
+
+	TSharedPtr<TextureSetCompilerTask> PreviewTask = MakeShared<TextureSetCompilerTask>(MakeShared<FTextureSetCompiler>(PreviewArgs), false);
+	PreviewTask->StartAsync(GetThreadPool(), EQueuedWorkPriority::Highest);
+	PreviewTasks.Add(TextureSet, PreviewTask);
+
+	UE_LOG(LogTextureSet, Verbose, TEXT("%s: starting %i pixel preview compilation"), *TextureSet->GetName(), PreviewSize);
+}
+
+void FTextureSetCompilingManager::DiscardPreviewCompilation(UTextureSet* const TextureSet)
+{
+	check(IsInGameThread());
+
+	TSharedPtr<TextureSetCompilerTask> PreviewTask;
+	if (PreviewTasks.RemoveAndCopyValue(TextureSet, PreviewTask) && !PreviewTask->Cancel())
+	{
+		PreviewTask->RequestCancel();
+		CancelledTasks.Add(PreviewTask);
+	}
+}
+
 bool FTextureSetCompilingManager::IsCompiling(const UTextureSet* TextureSet) const
 {
 	check(IsInGameThread());
@@ -375,6 +546,187 @@ void FTextureSetCompilingManager::NotifyMaterialInstances(TArrayView<UTextureSet
 	}
 }
 
+void FTextureSetCompilingManager::RequestPriority(const UTextureSet* TextureSet, ETextureSetCompilePriority Priority)
+{
+	check(IsInGameThread());
+
+	// Requests are only dropped once the texture set has compiled, so one for a texture set with nothing to compile would
+	// linger and promote its next, unrelated compilation
+	if (!IsQueued(TextureSet) && !IsCompiling(TextureSet))
+		return;
+
+	ETextureSetCompilePriority& RequestedPriority = RequestedPriorities.FindOrAdd(TextureSet, ETextureSetCompilePriority::Normal);
+
+	if (Priority > RequestedPriority)
+	{
+		RequestedPriority = Priority;
+		ReschedulePriority(const_cast<UTextureSet*>(TextureSet));
+	}
+}
+
+ETextureSetCompilePriority FTextureSetCompilingManager::GetPriority(const UTextureSet* TextureSet) const
+{
+	ETextureSetCompilePriority Priority = ETextureSetCompilePriority::Normal;
+
+	if (const ETextureSetCompilePriority* RequestedPriority = RequestedPriorities.Find(TextureSet))
+		Priority = *RequestedPriority;
+
+	if (EditedTextureSets.Contains(TextureSet))
+		Priority = FMath::Max(Priority, ETextureSetCompilePriority::Editing);
+
+	if (VisibleTextureSets.Contains(TextureSet))
+		Priority = FMath::Max(Priority, ETextureSetCompilePriority::Visible);
+
+	return Priority;
+}
+
+bool FTextureSetCompilingManager::QueueOrder(const FQueueEntry& A, const FQueueEntry& B)
+{
+	// Highest sort key on top of the heap, and the oldest entry wins a tie
+	return A.SortKey > B.SortKey || (A.SortKey == B.SortKey && A.Serial < B.Serial);
+}
+
+void FTextureSetCompilingManager::PushQueueEntry(const TWeakObjectPtr<UTextureSet>& TextureSet)
+{
+	FQueuedTextureSet& Queued = QueuedTextureSets.FindChecked(TextureSet);
+	Queued.Serial = NextQueueSerial++;
+
+	// Every texture set ages at the same rate, so the order only depends on when it was queued and never has to be
+	// recomputed. Waiting ts.QueueAgingSeconds is worth one level of priority.
+	const float AgingSeconds = CVarQueueAgingSeconds.GetValueOnGameThread();
+	const double SortKey = (double)Queued.Priority - (AgingSeconds > 0.0f ? Queued.QueueTime / AgingSeconds : 0.0);
+
+	QueueHeap.HeapPush(FQueueEntry{TextureSet, SortKey, Queued.Serial}, QueueOrder);
+
+	// Drop stale entries once they outnumber the live ones
+	if (QueueHeap.Num() > 2 * QueuedTextureSets.Num() + 64)
+	{
+		QueueHeap.RemoveAllSwap([this](const FQueueEntry& Entry)
+		{
+			const FQueuedTextureSet* Current = QueuedTextureSets.Find(Entry.TextureSet);
+			return !Current || Current->Serial != Entry.Serial;
+		});
+		QueueHeap.Heapify(QueueOrder);
+	}
+}
+
+void FTextureSetCompilingManager::ReschedulePriority(UTextureSet* TextureSet)
+{
+	const ETextureSetCompilePriority Priority = GetPriority(TextureSet);
+
+	if (FQueuedTextureSet* Queued = QueuedTextureSets.Find(TextureSet))
+	{
+		if (Queued->Priority != Priority)
+		{
+			Queued->Priority = Priority;
+			PushQueueEntry(TextureSet);
+		}
+	}
+
+	if (const TSharedPtr<TextureSetCompilerTask>* Task = AsyncCompilationTasks.Find(TextureSet))
+	{
+		const EQueuedWorkPriority WorkPriority = TextureSetCompilingManagerImpl::ToQueuedWorkPriority(Priority);
+
+		// Only matters while the compile work is still waiting in, or running on, the thread pool
+		if (!(*Task)->IsWorkDone() && (*Task)->GetPriority() != WorkPriority)
+			TextureSetCompilingManagerImpl::FCompilableTextureSet(TextureSet, *Task).Reschedule(GetThreadPool(), WorkPriority);
+	}
+}
+
+bool FTextureSetCompilingManager::GatherVisibleTextureSets(int32 MaxActors)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTextureSetCompilingManager::GatherVisibleTextureSets);
+	check(IsInGameThread());
+
+	// Materials are only gathered from primitives rendered since the last refresh. The walk resumes where the previous tick
+	// left it, so actors added or removed in the meantime may be missed until the next refresh, which is fine for a hint.
+	const float RenderedTolerance = FMath::Max(1.0f, CVarQueuePriorityRefreshSeconds.GetValueOnGameThread());
+	TSet<const UMaterialInterface*> VisitedMaterials;
+	TArray<UMaterialInterface*> Materials;
+	int32 NumActors = 0;
+
+	for (; HintCursor.World < HintWorlds.Num(); HintCursor.World++, HintCursor.Level = 0)
+	{
+		const UWorld* World = HintWorlds[HintCursor.World].Get();
+		if (!World)
+			continue;
+
+		const TArray<ULevel*>& Levels = World->GetLevels();
+
+		for (; HintCursor.Level < Levels.Num(); HintCursor.Level++, HintCursor.Actor = 0)
+		{
+			const ULevel* Level = Levels[HintCursor.Level];
+			if (!Level || !Level->bIsVisible)
+				continue;
+
+			for (; HintCursor.Actor < Level->Actors.Num(); HintCursor.Actor++)
+			{
+				if (NumActors++ >= MaxActors)
+					return false;
+
+				const AActor* Actor = Level->Actors[HintCursor.Actor];
+				if (!IsValid(Actor))
+					continue;
+
+				Actor->ForEachComponent<UPrimitiveComponent>(false, [&](const UPrimitiveComponent* Primitive)
+				{
+					if (!Primitive->IsRegistered() || !Primitive->WasRecentlyRendered(RenderedTolerance))
+						return;
+
+					Materials.Reset();
+					Primitive->GetUsedMaterials(Materials);
+
+					for (const UMaterialInterface* Material : Materials)
+						TextureSetCompilingManagerImpl::CollectTextureSets(Material, VisitedMaterials, GatheredVisibleTextureSets);
+				});
+			}
+		}
+	}
+
+	return true;
+}
+
+void FTextureSetCompilingManager::RefreshPriorities()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTextureSetCompilingManager::RefreshPriorities);
+	check(IsInGameThread());
+
+	EditedTextureSets.Reset();
+
+	if (GEditor)
+	{
+		if (UAssetEditorSubsystem* AssetEditorSubsystem = GEditor->GetEditorSubsystem<UAssetEditorSubsystem>())
+		{
+			for (UObject* Asset : AssetEditorSubsystem->GetAllEditedAssets())
+			{
+				if (const UTextureSet* TextureSet = Cast<UTextureSet>(Asset))
+					EditedTextureSets.Add(TextureSet);
+			}
+		}
+	}
+
+	VisibleTextureSets = MoveTemp(GatheredVisibleTextureSets);
+	GatheredVisibleTextureSets.Reset();
+
+	for (auto It = RequestedPriorities.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+			It.RemoveCurrent();
+	}
+
+	TArray<TWeakObjectPtr<UTextureSet>> TextureSets;
+	QueuedTextureSets.GetKeys(TextureSets);
+
+	for (const auto& [TextureSet, Task] : AsyncCompilationTasks)
+		TextureSets.Add(TextureSet);
+
+	for (const TWeakObjectPtr<UTextureSet>& TextureSet : TextureSets)
+	{
+		if (TextureSet.IsValid())
+			ReschedulePriority(TextureSet.Get());
+	}
+}
+
 TSharedRef<FTextureSetCompilerArgs> FTextureSetCompilingManager::MakeCompilerArgs(UTextureSet* TextureSet)
 {
 	check(IsInGameThread());
@@ -414,6 +766,28 @@ void FTextureSetCompilingManager::ProcessTextureSets(bool bLimitExecutionTime)
 		return bLimitExecutionTime ? ((FPlatformTime::Seconds() - TickStartTime) < MaxSecondsPerFrame) : true;
 	};
 
+	CancelledTasks.RemoveAllSwap([](const TSharedPtr<TextureSetCompilerTask>& Task) { return Task->IsDone(); });
+
+	if (PreviewTasks.Num() > 0)
+	{
+		TArray<UTextureSet*> PreviewedTextureSets;
+		for (auto It = PreviewTasks.CreateIterator(); It; ++It)
+		{
+			if (HasTimeLeft() && It.Value()->TryFinalize())
+			{
+				// Previews stay in the transient package, and in their own transient field, so they're never saved
+				UTextureSet* TextureSet = It.Key();
+				TextureSet->PreviewDerivedData = It.Value()->GetDerivedData();
+				PreviewedTextureSets.Add(TextureSet);
+				It.RemoveCurrent();
+
+				UE_LOG(LogTextureSet, Verbose, TEXT("%s: showing preview until compilation finishes"), *TextureSet->GetName());
+			}
+		}
+
+		NotifyMaterialInstances(PreviewedTextureSets);
+	}
+
 	if (AsyncCompilationTasks.Num() > 0)
 	{
 		TArray<UTextureSet*> FinishedTextureSets;
@@ -432,39 +806,125 @@ void FTextureSetCompilingManager::ProcessTextureSets(bool bLimitExecutionTime)
 		NotifyMaterialInstances(FinishedTextureSets);
 	}
 
-	int32 MaxParallel = CVarMaxAsyncTextureSetParallelCompiles.GetValueOnGameThread();
+	// Gathering hints walks the worlds' actors, so it's only started periodically and only while there is work to order,
+	// and is spread over ticks at ts.QueuePriorityActorsPerTick actors per tick
+	if (GetNumRemainingAssets() > 0 && !IsLoading())
+	{
+		if (!bGatheringHints && FPlatformTime::Seconds() - LastReschedule >= CVarQueuePriorityRefreshSeconds.GetValueOnGameThread())
+		{
+			HintWorlds.Reset();
+			HintCursor = FHintCursor();
+			GatheredVisibleTextureSets.Reset();
 
-	int64 MemoryLimit = TextureSetManagerGetMemoryLimit();
-	const uint64 MemoryPerTextureSet = 4ULL * 1024 * 1024 * 1024; // Memory per Texture Set Compilation
-	int32 MaximumParallelAllowedByMemory = MemoryLimit / MemoryPerTextureSet;
+			if (GEditor)
+			{
+				HintWorlds.Add(GEditor->GetEditorWorldContext().World());
+				HintWorlds.Add(GEditor->PlayWorld.Get());
+			}
+
+			bGatheringHints = true;
+		}
+
+		if (bGatheringHints && GatherVisibleTextureSets(FMath::Max(1, CVarQueuePriorityActorsPerTick.GetValueOnGameThread())))
+		{
+			bGatheringHints = false;
+			RefreshPriorities();
+			LastReschedule = FPlatformTime::Seconds();
+		}
+	}
 
-	MaxParallel = FMath::Min(FMath::Max(1, GLargeThreadPool->GetNumThreads() / 2), MaxParallel);
-	MaxParallel = FMath::Min(MaximumParallelAllowedByMemory, MaxParallel);
+	const int32 MaxParallel = CVarMaxAsyncTextureSetParallelCompiles.GetValueOnGameThread();
 
 	if (QueuedTextureSets.Num() > 0 && !IsLoading() && AsyncCompilationTasks.Num() < MaxParallel)
 	{
+		const float EstimateScale = FMath::Max(0.0f, CVarCompilationMemoryEstimateScale.GetValueOnGameThread());
+
+		// Memory already allocated by running compilations is missing from the limit, but they may not have reached their
+		// peak yet, so their whole estimate stays reserved until their work is done. This errs on the side of admitting less.
+		int64 MemoryBudget = TextureSetManagerGetMemoryLimit();
+		int32 NumRunning = 0;
+
+		for (const auto& [TextureSet, Task] : AsyncCompilationTasks)
+		{
+			if (!Task->IsWorkDone())
+			{
+				MemoryBudget -= Task->GetEstimatedPeakMemory() * EstimateScale;
+				NumRunning++;
+			}
+		}
+
+		// Cancelled tasks hold on to their memory until they notice, which is normally within a tile
+		for (const TSharedPtr<TextureSetCompilerTask>& Task : CancelledTasks)
+			MemoryBudget -= Task->GetEstimatedPeakMemory() * EstimateScale;
+
 		TArray<UTextureSet*> TextureSetsToStart;
-		TArray<TWeakObjectPtr<UTextureSet>> TextureSetsToDequeue;
-		TextureSetsToStart.Reserve(FMath::Min(QueuedTextureSets.Num(), MaxParallel));
+		TArray<FQueueEntry> DeferredEntries;
 
-		for (const TWeakObjectPtr<UTextureSet> QueuedTextureSet : QueuedTextureSets)
+		while (QueueHeap.Num() > 0 && HasTimeLeft())
 		{
-			if (!HasTimeLeft())
-				break;
-			
+			const TWeakObjectPtr<UTextureSet> QueuedTextureSet = QueueHeap.HeapTop().TextureSet;
+			const FQueuedTextureSet* Queued = QueuedTextureSets.Find(QueuedTextureSet);
+
+			if (!Queued || Queued->Serial != QueueHeap.HeapTop().Serial)
+			{
+				// Stale entry, the texture set has started or been pushed again with a new priority since
+				QueueHeap.HeapPopDiscard(QueueOrder);
+				continue;
+			}
+
 			if (!QueuedTextureSet.IsValid())
 			{
 				// Texture Set may be null if deleted or garbage collected
-				TextureSetsToDequeue.Add(QueuedTextureSet);
-				break;
+				QueuedTextureSets.Remove(QueuedTextureSet);
+				QueueHeap.HeapPopDiscard(QueueOrder);
+				continue;
 			}
 
 			UTextureSet* TextureSet = QueuedTextureSet.Get();
 
+			// A redundant requeue (e.g. an edit that doesn't affect compilation) must not cancel a running compile that is still
+			// valid, so compare against the in-flight task before TryCancelCompilation gets a chance to throw it away
+			if (const TSharedPtr<TextureSetCompilerTask>* InFlightTask = AsyncCompilationTasks.Find(TextureSet))
+			{
+				if ((*InFlightTask)->GetCompiler()->Equivalent(MakeShared<FTextureSetCompiler>(MakeCompilerArgs(TextureSet)).Get()))
+				{
+					UE_LOG(LogTextureSet, Verbose, TEXT("%s: already compiling the same data, dropping the queued compilation"), *TextureSet->GetName());
+					QueuedTextureSets.Remove(QueuedTextureSet);
+					QueueHeap.HeapPopDiscard(QueueOrder);
+					continue;
+				}
+			}
+
+			// Estimated from the source metadata, since preparing a compiler loads and hashes sources. The compiler is only
+			// created and prepared once the texture set is admitted, and its task then publishes the prepared estimate.
+			int64& CachedEstimate = QueuedTextureSets.FindChecked(QueuedTextureSet).EstimatedMemory;
+			if (CachedEstimate < 0)
+				CachedEstimate = FTextureSetCompiler::EstimatePeakMemory(*MakeCompilerArgs(TextureSet));
+
+			const int64 EstimatedMemory = CachedEstimate * EstimateScale;
+
+			// Always admit one compilation when nothing is running, so texture sets bigger than the budget still compile.
+			// Otherwise stop at the first one that doesn't fit, so big texture sets aren't starved by smaller ones behind them.
+			if (EstimatedMemory > MemoryBudget && (NumRunning + TextureSetsToStart.Num()) > 0)
+			{
+				UE_LOG(LogTextureSet, Verbose, TEXT("%s: waiting to compile, needs an estimated %.1fMB with %.1fMB available"),
+					*TextureSet->GetName(), EstimatedMemory / (1024.0 * 1024.0), MemoryBudget / (1024.0 * 1024.0));
+				break;
+			}
+
+			FQueueEntry Entry;
+			QueueHeap.HeapPop(Entry, QueueOrder);
+
 			if (!AsyncCompilationTasks.Contains(TextureSet) || TryCancelCompilation(TextureSet))
 			{
 				// The texture set is not currently compiling, or was but the async job could be cancelled, so we are safe to kick it off.
 				TextureSetsToStart.Add(TextureSet);
+				MemoryBudget -= EstimatedMemory;
+			}
+			else
+			{
+				// Try again next tick, once the previous compilation has finished
+				DeferredEntries.Add(Entry);
 			}
 
 			// Do not continue starting texture sets if we'll be at our max
@@ -472,9 +932,9 @@ void FTextureSetCompilingManager::ProcessTextureSets(bool bLimitExecutionTime)
 				break;
 		}
 
-		for (const TWeakObjectPtr<UTextureSet>& TextureSet : TextureSetsToDequeue)
+		for (const FQueueEntry& Entry : DeferredEntries)
 		{
-			QueuedTextureSets.Remove(TextureSet);
+			QueueHeap.HeapPush(Entry, QueueOrder);
 		}
 
 		for (UTextureSet* TextureSet : TextureSetsToStart)
@@ -483,6 +943,18 @@ void FTextureSetCompilingManager::ProcessTextureSets(bool bLimitExecutionTime)
 			StartCompilation(TextureSet);
 		}
 	}
+
+	int64 EstimatedMemoryInFlight = 0;
+	for (const auto& [TextureSet, Task] : AsyncCompilationTasks)
+	{
+		if (!Task->IsWorkDone())
+			EstimatedMemoryInFlight += Task->GetEstimatedPeakMemory();
+	}
+
+	for (const TSharedPtr<TextureSetCompilerTask>& Task : CancelledTasks)
+		EstimatedMemoryInFlight += Task->GetEstimatedPeakMemory();
+
+	TRACE_COUNTER_SET(TextureSetCompilationEstimatedMemory, EstimatedMemoryInFlight);
 }
 
 void FTextureSetCompilingManager::RefreshMaterialInstances()
@@ -555,6 +1027,8 @@ void FTextureSetCompilingManager::RefreshMaterialInstances()
 
 void FTextureSetCompilingManager::AssignDerivedData(UTextureSetDerivedData* NewDerivedData, UTextureSet* TextureSet)
 {
+	checkf(!NewDerivedData->bIsPreview, TEXT("%s: Preview derived data must only be assigned to PreviewDerivedData"), *TextureSet->GetName());
+
 	FString DerivedDataName = TEXT("DerivedData");
 
 	ERenameFlags RenameFlags = REN_DoNotDirty | REN_DontCreateRedirectors;
@@ -567,9 +1041,13 @@ void FTextureSetCompilingManager::AssignDerivedData(UTextureSetDerivedData* NewD
 		ExistingDerivedData->ConditionalBeginDestroy();
 	}
 
+	// Priority requests only last until the texture set has compiled
+	RequestedPriorities.Remove(TextureSet);
+
 	// Reparent the derived data to the texture set
 	NewDerivedData->Rename(*DerivedDataName, TextureSet, RenameFlags);
 	TextureSet->DerivedData = NewDerivedData;
+	TextureSet->PreviewDerivedData = nullptr;
 
 	// Default texture set derived textures need to be public so they can be referenced as default textures in the generated graphs.
 	if (TextureSet->IsDefaultTextureSet())
@@ -216,6 +216,19 @@ FGuid UTextureSetDefinition::ComputeCompilationHash()
 }
 #endif
 
+#if WITH_EDITOR
+void UTextureSetDefinition::SetEdits(const TArray<UTextureSetModule*>& Modules, const TArray<FTextureSetPackedTextureDef>& PackedTextures)
+{
+	EditModules = Modules;
+	EditPackedTextures = PackedTextures;
+
+	for (FTextureSetPackedTextureDef& PackedTextureDef : EditPackedTextures)
+		PackedTextureDef.UpdateAvailableChannels();
+
+	ApplyEdits();
+}
+#endif
+
 #if WITH_EDITOR
 void UTextureSetDefinition::ResetEdits()
 {
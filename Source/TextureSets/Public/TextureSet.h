@@ -103,8 +103,18 @@ private:
 	UPROPERTY(Transient, DuplicateTransient, VisibleAnywhere, Category="Debug", AdvancedDisplay)
 	TObjectPtr<UTextureSetDerivedData> DerivedData;
 
+#if WITH_EDITORONLY_DATA
+	// Low resolution derived data shown by materials while DerivedData is compiling (see ts.PreviewSize).
+	// Kept apart from DerivedData so it's never serialized, or returned by GetDerivedData().
+	UPROPERTY(Transient, DuplicateTransient)
+	TObjectPtr<UTextureSetDerivedData> PreviewDerivedData;
+#endif
+
 	FDelegateHandle OnTextureSetDefinitionChangedHandle;
 
+	// Derived data to set material parameters from, which is the preview while compiling if there is one
+	const UTextureSetDerivedData* GetMaterialDerivedData() const;
+
 #if WITH_EDITOR
 	void OnDefinitionChanged(UTextureSetDefinition* ChangedDefinition);
 #endif
@@ -14,11 +14,22 @@
 
 class UMaterialInstance;
 class UTextureSet;
+class UWorld;
 class FQueuedThreadPool;
 enum class EQueuedWorkPriority : uint8;
 
 DECLARE_MULTICAST_DELEGATE_OneParam(FTextureSetPostCompileEvent, const TArrayView<UTextureSet* const>&);
 
+// How urgently a texture set's derived data is wanted. Orders the compilation queue, and sets the thread pool priority
+// of compilations in flight.
+enum class ETextureSetCompilePriority : uint8
+{
+	Normal,  // Nothing is known to be waiting on it
+	Visible, // Used by a primitive in the editor or PIE world
+	Editing, // Open in an asset editor
+	Stalled, // Something is blocked waiting for its derived data
+};
+
 class TEXTURESETS_API FTextureSetCompilingManager : IAssetCompilingManager
 {
 public:
@@ -39,6 +50,11 @@ public:
 	bool IsQueued(const UTextureSet* TextureSet) const;
 	bool IsRegistered(const UTextureSet* TextureSet) const;
 
+	// Raises the priority of a texture set's compilation, queued or in flight, until it has compiled. Ignored if the texture set
+	// is neither queued nor compiling.
+	// Hints for texture sets open in editors or used in the world are gathered automatically.
+	void RequestPriority(const UTextureSet* TextureSet, ETextureSetCompilePriority Priority);
+
 	// Blocks until completion of all async texture set compilation.
 	void FinishAllCompilation() override;
 
@@ -63,13 +79,38 @@ private:
 
 	FTextureSetCompilingManager();
 
+	struct FQueuedTextureSet
+	{
+		double QueueTime;
+		ETextureSetCompilePriority Priority;
+		uint32 Serial; // Serial of the current entry in QueueHeap, older entries of the same texture set are stale
+		int64 EstimatedMemory = -1; // Cached FTextureSetCompiler::EstimatePeakMemory(Args), or -1 until it's first needed
+	};
+
+	struct FQueueEntry
+	{
+		TWeakObjectPtr<UTextureSet> TextureSet;
+		double SortKey; // Priority, minus the time queued in units of ts.QueueAgingSeconds
+		uint32 Serial;
+	};
+
 	FName GetAssetTypeName() const override;
 	FTextFormat GetAssetNameFormat() const override;
 	TArrayView<FName> GetDependentTypeNames() const override;
 	int32 GetNumRemainingAssets() const override;
 	void ProcessAsyncTasks(bool bLimitExecutionTime = false) override;
 
+	void StartCompilation(UTextureSet* const InTextureSet, TSharedRef<FTextureSetCompiler> Compiler, bool bAsync = true);
+	void StartPreviewCompilation(UTextureSet* const TextureSet, const TSharedRef<FTextureSetCompiler>& Compiler);
+	void DiscardPreviewCompilation(UTextureSet* const TextureSet);
 	void ProcessTextureSets(bool bLimitExecutionTime);
+	static bool QueueOrder(const FQueueEntry& A, const FQueueEntry& B);
+	void PushQueueEntry(const TWeakObjectPtr<UTextureSet>& TextureSet);
+	// Visits up to MaxActors more actors of HintWorlds, collecting the texture sets their rendered primitives use. True once done.
+	bool GatherVisibleTextureSets(int32 MaxActors);
+	void RefreshPriorities();
+	ETextureSetCompilePriority GetPriority(const UTextureSet* TextureSet) const;
+	void ReschedulePriority(UTextureSet* TextureSet);
 	void AssignDerivedData(UTextureSetDerivedData* NewDerivedData, UTextureSet* TextureSet);
 	bool AllDependenciesLoaded(UMaterialInstance* MaterialInstance);
 	void RefreshMaterialInstances();
@@ -80,8 +121,34 @@ private:
 	double LastReschedule = 0.0f;
 	bool bHasShutdown = false;
 
-	TSet<TWeakObjectPtr<UTextureSet>> QueuedTextureSets;
+	TMap<TWeakObjectPtr<UTextureSet>, FQueuedTextureSet> QueuedTextureSets;
+	// Max heap on SortKey. Entries are pushed again when their priority changes, rather than updated in place.
+	TArray<FQueueEntry> QueueHeap;
+	uint32 NextQueueSerial = 0;
+
+	// Priority hints. Requested priorities last until the texture set has compiled, gathered ones until the next refresh.
+	TMap<TWeakObjectPtr<const UTextureSet>, ETextureSetCompilePriority> RequestedPriorities;
+	TSet<TWeakObjectPtr<const UTextureSet>> EditedTextureSets;
+	TSet<TWeakObjectPtr<const UTextureSet>> VisibleTextureSets;
+
+	// Progress of the walk over the worlds' actors that gathers VisibleTextureSets, which is spread over several ticks
+	struct FHintCursor
+	{
+		int32 World = 0;
+		int32 Level = 0;
+		int32 Actor = 0;
+	};
+
+	bool bGatheringHints = false;
+	TArray<TWeakObjectPtr<UWorld>> HintWorlds;
+	FHintCursor HintCursor;
+	TSet<TWeakObjectPtr<const UTextureSet>> GatheredVisibleTextureSets;
+
 	TMap<UTextureSet*, TSharedPtr<TextureSetCompilerTask>> AsyncCompilationTasks;
+	// Low resolution compilations, shown until the full resolution compilation of the same texture set finishes
+	TMap<UTextureSet*, TSharedPtr<TextureSetCompilerTask>> PreviewTasks;
+	// Tasks which were asked to stop after their work had started, kept alive until their work has wound down
+	TArray<TSharedPtr<TextureSetCompilerTask>> CancelledTasks;
 	//auto& [TextureSet, Task]
 	FAsyncCompilationNotification Notification;
 	TSet<const UTextureSet*> MaterialInstancesToUpdate;
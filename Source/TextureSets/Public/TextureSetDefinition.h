@@ -67,6 +67,10 @@ public:
 
 #if WITH_EDITOR
 	FGuid ComputeCompilationHash();
+
+	// Replaces the modules and packing as if they had been edited by the user, and applies them.
+	// Used to build definitions from code, e.g. for benchmarking.
+	void SetEdits(const TArray<UTextureSetModule*>& Modules, const TArray<FTextureSetPackedTextureDef>& PackedTextures);
 #endif
 
 	FGuid GetGuid() const { return UniqueID; }
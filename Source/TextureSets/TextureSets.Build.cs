@@ -43,6 +43,7 @@ public class TextureSets : ModuleRules
 					"TextureSetsCompiler",
 					"TextureSetsMaterialBuilder",
 					"MaterialEditor",
+					"UnrealEd",
 				}
 				);
 		}
@@ -105,6 +105,8 @@ FTextureSetPackingInfo::FTextureSetPackingInfo(const TArray<FTextureSetPackedTex
 		TextureInfo.ChannelCount = TextureDef.GetSources().Num();
 		TextureInfo.RangeCompressMulName = FName("RangeCompress_" + FString::FromInt(i) + "_Mul");
 		TextureInfo.RangeCompressAddName = FName("RangeCompress_" + FString::FromInt(i) + "_Add");
+		TextureInfo.ConstantEnabledName = FName("Constant_" + FString::FromInt(i) + "_Enabled");
+		TextureInfo.ConstantValueName = FName("Constant_" + FString::FromInt(i) + "_Value");
 
 		PackedTextureDefs.Add(TextureDef);
 		PackedTextureInfos.Add(TextureInfo);
@@ -103,6 +103,9 @@ public:
 #if WITH_EDITOR
 	// Use this critical section when editing the MaterialParameters map
 	FCriticalSection ParameterCS;
+
+	// Low resolution stand-in shown while the full resolution data compiles, only ever held in UTextureSet::PreviewDerivedData
+	bool bIsPreview = false;
 #endif
 
 	// UObject Interface
@@ -172,6 +172,13 @@ public:
 
 	UPROPERTY(VisibleAnywhere, Category="Info")
 	FName RangeCompressAddName;
+
+	// Set (x > 0) when every channel is constant, and the decoded values should be read from ConstantValueName instead of sampling
+	UPROPERTY(VisibleAnywhere, Category="Info")
+	FName ConstantEnabledName;
+
+	UPROPERTY(VisibleAnywhere, Category="Info")
+	FName ConstantValueName;
 };
 
 // Info about and derived from the packing definition
@@ -0,0 +1,99 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#include "ProcessingNodes/ProcessingNodeTrace.h"
+
+#include "Misc/ScopeRWLock.h"
+
+namespace ProcessingNodeTraceImpl
+{
+	static const TCHAR* StageNames[(int32)EProcessingNodeTraceStage::Num] = { TEXT("Prepare"), TEXT("Cache"), TEXT("WriteChannels") };
+
+	static FRWLock TypesLock;
+	static TMap<FName, FProcessingNodeTraceType*> Types;
+
+	// Registering counters writes to the trace, so two threads registering the same counter would create two of them
+	static FCriticalSection CounterRegistrationCS;
+}
+
+FProcessingNodeTraceType& FProcessingNodeTraceType::Get(FName NodeTypeName)
+{
+	using namespace ProcessingNodeTraceImpl;
+
+	{
+		FReadScopeLock ReadLock(TypesLock);
+		if (FProcessingNodeTraceType* const* Type = Types.Find(NodeTypeName))
+			return **Type;
+	}
+
+	FWriteScopeLock WriteLock(TypesLock);
+	FProcessingNodeTraceType*& Type = Types.FindOrAdd(NodeTypeName, nullptr);
+	if (!Type)
+		Type = new FProcessingNodeTraceType(NodeTypeName);
+
+	return *Type;
+}
+
+FProcessingNodeTraceType::FProcessingNodeTraceType(FName NodeTypeName)
+	: Name(NodeTypeName.ToString())
+	, PixelsCounterId(0)
+	, BytesCounterId(0)
+	, PixelsWritten(0)
+	, BytesWritten(0)
+{
+	for (std::atomic<uint32>& SpecId : SpecIds)
+		SpecId = 0;
+}
+
+bool FProcessingNodeTraceType::BeginScope(EProcessingNodeTraceStage Stage)
+{
+#if CPUPROFILERTRACE_ENABLED
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel))
+		return false;
+
+	std::atomic<uint32>& SpecId = SpecIds[(int32)Stage];
+	uint32 Id = SpecId.load(std::memory_order_relaxed);
+
+	if (Id == 0)
+	{
+		// Racing threads may both register the spec, which only costs a duplicate name in the trace
+		const FString ScopeName = FString::Printf(TEXT("TextureSet %s::%s"), *Name, ProcessingNodeTraceImpl::StageNames[(int32)Stage]);
+		Id = FCpuProfilerTrace::OutputEventType(*ScopeName);
+		SpecId.store(Id, std::memory_order_relaxed);
+	}
+
+	FCpuProfilerTrace::OutputBeginEvent(Id);
+	return true;
+#else
+	return false;
+#endif
+}
+
+void FProcessingNodeTraceType::EndScope()
+{
+#if CPUPROFILERTRACE_ENABLED
+	FCpuProfilerTrace::OutputEndEvent();
+#endif
+}
+
+void FProcessingNodeTraceType::AddWritten(int64 Pixels, int64 Bytes)
+{
+#if COUNTERSTRACE_ENABLED
+	if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(CountersChannel))
+		return;
+
+	if (PixelsCounterId.load(std::memory_order_acquire) == 0)
+	{
+		FScopeLock Lock(&ProcessingNodeTraceImpl::CounterRegistrationCS);
+
+		if (PixelsCounterId.load(std::memory_order_relaxed) == 0)
+		{
+			BytesCounterId = FCountersTrace::OutputInitCounter(*FString::Printf(TEXT("TextureSets/Nodes/%s/Bytes"), *Name), TraceCounterType_Int, TraceCounterDisplayHint_Memory);
+			PixelsCounterId.store(FCountersTrace::OutputInitCounter(*FString::Printf(TEXT("TextureSets/Nodes/%s/Pixels"), *Name), TraceCounterType_Int, TraceCounterDisplayHint_None), std::memory_order_release);
+		}
+	}
+
+	// Totals since the process started, so the slope of the counter is the throughput of the node type
+	FCountersTrace::OutputSetValue(PixelsCounterId, PixelsWritten += Pixels);
+	FCountersTrace::OutputSetValue(BytesCounterId, BytesWritten += Bytes);
+#endif
+}
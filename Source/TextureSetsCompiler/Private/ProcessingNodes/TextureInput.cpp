@@ -33,3 +33,21 @@ void FTextureInput::InstantiateOperators(const FTextureSetProcessingGraph& Graph
 	for (const CreateOperatorFunc& Func : CreateOperatorFuncs)
 		LastNode = Operators.Add_GetRef(Func(LastNode.ToSharedRef()));
 }
+
+void FTextureInput::SetTextureRead(TSharedRef<FTextureRead> NewTextureRead, const FTextureSetProcessingGraph& Graph)
+{
+	TextureRead = NewTextureRead;
+	Operators.Empty();
+	LastNode = nullptr;
+
+	InstantiateOperators(Graph);
+}
+
+void FTextureInput::ShareOperators(const FTextureInput& Other)
+{
+	check(Other.LastNode);
+
+	TextureRead = Other.TextureRead;
+	Operators = Other.Operators;
+	LastNode = Other.LastNode;
+}
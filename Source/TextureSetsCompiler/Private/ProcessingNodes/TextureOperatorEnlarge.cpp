@@ -1,147 +1,212 @@
 // Copyright (c) 2024 Electronic Arts. All Rights Reserved.
 
-#pragma once
-
 #include "ProcessingNodes/TextureOperatorEnlarge.h"
 
+#include "Misc/ScopeExit.h"
+
+namespace TextureOperatorEnlargeImpl
+{
+	// The two source samples and the lerp between them for one output coordinate along an axis,
+	// with the sample indices relative to the start of the source tile.
+	struct FAxisTaps
+	{
+		int32 Index0;
+		int32 Index1;
+		float Lerp;
+	};
+
+	using FAxisTapsArray = TArray<FAxisTaps, TInlineAllocator<64>>;
+
+	// Computes the taps of every coordinate of a tile along one axis, so they are evaluated once per row or column of the tile
+	// rather than once per pixel. Uses the same math as TransformToSource() and CalulateInterp(), so results match exactly.
+	static void ComputeAxisTaps(FAxisTapsArray& OutTaps, int32 TileOffset, int32 TileSize, int32 TargetSize, int32 SourceSize, int32 SourceTileOffset, int32 SourceTileSize)
+	{
+		const double Ratio = (float)SourceSize / (float)TargetSize;
+
+		OutTaps.SetNumUninitialized(TileSize);
+
+		for (int32 i = 0; i < TileSize; i++)
+		{
+			const int32 TargetCoord = TileOffset + i;
+			const int32 SourceCoord = (int32)((double)TargetCoord * Ratio) - SourceTileOffset;
+
+			OutTaps[i].Index0 = FMath::Min(SourceCoord, SourceTileSize - 1);
+			OutTaps[i].Index1 = FMath::Min(SourceCoord + 1, SourceTileSize - 1);
+			OutTaps[i].Lerp = FTextureOperatorEnlarge::CalulateInterp(TargetCoord, TargetSize, SourceSize);
+		}
+	}
+
+	// Scratch buffers, kept per thread so tiles don't allocate. If an enlarge nests inside another on the same thread,
+	// the inner one falls back to its own buffers.
+	struct FScratch
+	{
+		TArray64<float> Source;
+		TArray64<float> Plane;
+		TArray64<float> Row;
+		bool bInUse = false;
+	};
+
+	// Buffers grow to fit the tile, so a thread settles on the size of its largest tile
+	static float* GetScratch(TArray64<float>& Buffer, int64 Num)
+	{
+		if (Buffer.Num() < Num)
+			Buffer.SetNumUninitialized(Num);
+
+		return Buffer.GetData();
+	}
+
+	// Most scratch memory a worker thread keeps between tiles. Tiles are normally sized to fit ts.TileCacheBudgetKB, so this
+	// only releases the buffers of unusually large tiles, rather than pinning that memory on the thread for good.
+	static constexpr int64 MaxRetainedScratchBytes = 4 * 1024 * 1024;
+
+	static void TrimScratch(FScratch& Scratch)
+	{
+		const int64 RetainedBytes = (Scratch.Source.Max() + Scratch.Plane.Max() + Scratch.Row.Max()) * sizeof(float);
+
+		if (RetainedBytes > MaxRetainedScratchBytes)
+		{
+			Scratch.Source.Empty();
+			Scratch.Plane.Empty();
+			Scratch.Row.Empty();
+		}
+	}
+
+	static thread_local FScratch ThreadScratch;
+}
+
 void FTextureOperatorEnlarge::WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const
 {
+	WriteChannels(1 << Channel, Tile.OffsetData(-Channel), TextureData);
+}
+
+void FTextureOperatorEnlarge::WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const
+{
+	using namespace TextureOperatorEnlargeImpl;
+
+	if (ChannelMask == 0)
+		return;
+
+	TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile);
+
 	const FIntVector TargetSize = FIntVector(TargetWidth, TargetHeight, TargetSlices);
 	const FTextureDimension SourceDimension = SourceImage->GetTextureDimension();
 	const FTextureSetProcessedTextureDef SourceDef = GetTextureDef();
 	const FIntVector SourceSize = FIntVector(SourceDimension.Width, SourceDimension.Height, SourceDimension.Slices);
 
-	auto TransformToSource = [&TargetSize, &SourceSize](const FIntVector& Position)
+	// Requested channels, which are interleaved in the temp buffer from the lowest to the highest requested channel
+	TArray<int32, TInlineAllocator<4>> Channels;
+	for (int32 Channel = 0; Channel < 4; Channel++)
 	{
-		FVector Ratio(
-			(float)SourceSize.X / (float)TargetSize.X,
-			(float)SourceSize.Y / (float)TargetSize.Y,
-			(float)SourceSize.Z / (float)TargetSize.Z
-		);
+		if (ChannelMask & (1 << Channel))
+			Channels.Add(Channel);
+	}
 
-		return FIntVector(FVector(Position) * Ratio);
-	};
+	const int32 FirstChannel = Channels[0];
+	const int32 SourceElementStride = Channels.Last() - FirstChannel + 1;
 
-	auto CalulateInterp = [](int32 TargetCoord, int32 TargetSize, int32 SourceSize)
-	{
-		return float((TargetCoord * SourceSize) % TargetSize) / float(TargetSize);
-	};
+	// The tile of the source image we need to enlarge
+	const FIntVector SourceTileOffset = TransformToSource(Tile.TileOffset);
+	const FIntVector SourceTileSize = (TransformToSource(Tile.TileSize) + FIntVector(1,1,1)).ComponentMin(SourceSize - SourceTileOffset);
+
+	FScratch LocalScratch;
+	FScratch& Scratch = ThreadScratch.bInUse ? LocalScratch : ThreadScratch;
+	TGuardValue<bool> InUseGuard(Scratch.bInUse, true);
+	ON_SCOPE_EXIT { TrimScratch(Scratch); };
 
-	// Create a temp buffer to hold the tile of the image we need to enlarge
-	FIntVector SourceTileOffset = TransformToSource(Tile.TileOffset);
-	FIntVector SourceTileSize = (TransformToSource(Tile.TileSize) + FIntVector(1,1,1)).ComponentMin(SourceSize - SourceTileOffset);
-		
-	TArray64<float> SourceTextureData;
-	SourceTextureData.SetNumUninitialized(SourceTileSize.X * SourceTileSize.Y * SourceTileSize.Z);
+	float* SourceTextureData = GetScratch(Scratch.Source, (int64)SourceTileSize.X * SourceTileSize.Y * SourceTileSize.Z * SourceElementStride);
 
+	// Offset the data so the first requested channel lands at the start of the buffer
 	FTextureDataTileDesc SourceTile = FTextureDataTileDesc(
 		SourceSize,
 		SourceTileSize,
 		SourceTileOffset,
-		FTextureDataTileDesc::ComputeDataStrides(1, SourceTileSize),
-		0
+		FTextureDataTileDesc::ComputeDataStrides(SourceElementStride, SourceTileSize),
+		-FirstChannel
 	);
-		
-	SourceImage->WriteChannel(Channel, SourceTile, SourceTextureData.GetData());
+
+	SourceImage->WriteChannels(ChannelMask, SourceTile, SourceTextureData);
 
 	// Don't do trilinear filtering for 2d textures, or texture arrays.
 	const bool bTrilinear = SourceTileSize.Z > 0 && !(SourceDef.Flags & (uint8)ETextureSetTextureFlags::Array);
 
-	FTextureDataTileDesc::ForEachPixelContext Context;
-	Context.DataIndex = Tile.TileDataOffset;
-	FVector3f Lerp;
-
-	if (bTrilinear)
+	FAxisTapsArray TapsX, TapsY, TapsZ;
+	ComputeAxisTaps(TapsX, Tile.TileOffset.X, Tile.TileSize.X, TargetSize.X, SourceSize.X, SourceTileOffset.X, SourceTileSize.X);
+	ComputeAxisTaps(TapsY, Tile.TileOffset.Y, Tile.TileSize.Y, TargetSize.Y, SourceSize.Y, SourceTileOffset.Y, SourceTileSize.Y);
+	ComputeAxisTaps(TapsZ, Tile.TileOffset.Z, Tile.TileSize.Z, TargetSize.Z, SourceSize.Z, SourceTileOffset.Z, SourceTileSize.Z);
+
+	// Filtering is separable, so it's done one axis at a time: Z into a plane, Y into a row, and then X into the output.
+	// Lerps are applied in the same order, and skipped for the same zero weights, as a per-pixel trilinear filter would,
+	// so the result is identical to it. Planes and rows which don't need a lerp are read from the source in place.
+	// Indices are relative to the first requested channel, matching the layout of the source buffer.
+	const FInt64Vector3 SourceStride = SourceTile.TileDataStride;
+	const int64 PlaneSize = SourceStride.Z;
+	float* PlaneScratch = bTrilinear ? GetScratch(Scratch.Plane, PlaneSize) : nullptr;
+	float* RowScratch = GetScratch(Scratch.Row, SourceStride.Y);
+
+	for (int32 Z = 0; Z < Tile.TileSize.Z; Z++)
 	{
-		for (Context.TileCoord.Z = 0; Context.TileCoord.Z < Tile.TileSize.Z; Context.TileCoord.Z++)
+		const FAxisTaps& TapZ = TapsZ[Z];
+		const float* Plane = SourceTextureData + TapZ.Index0 * PlaneSize;
+
+		if (bTrilinear && TapZ.Lerp > 0)
 		{
-			Lerp.Z = CalulateInterp(Context.TileCoord.Z + Tile.TileOffset.Z, TargetSize.Z, SourceSize.Z);
+			const float* Plane0 = Plane;
+			const float* Plane1 = SourceTextureData + TapZ.Index1 * PlaneSize;
 
-			for (Context.TileCoord.Y = 0; Context.TileCoord.Y < Tile.TileSize.Y; Context.TileCoord.Y++)
+			for (int64 i = 0; i < SourceTileSize.X * SourceTileSize.Y; i++)
 			{
-				Lerp.Y = CalulateInterp(Context.TileCoord.Y + Tile.TileOffset.Y, TargetSize.Y, SourceSize.Y);
-
-				for (Context.TileCoord.X = 0; Context.TileCoord.X < Tile.TileSize.X; Context.TileCoord.X++)
+				for (const int32 Channel : Channels)
 				{
-					Lerp.X = CalulateInterp(Context.TileCoord.X + Tile.TileOffset.X, TargetSize.X, SourceSize.X);
-
-					const FIntVector SourceBaseCoord = TransformToSource(Context.TileCoord + Tile.TileOffset) - SourceTile.TileOffset;
-		
-					float Values[2][2][2];
-		
-					// Initialize values
-					for(int x = 0; x < 2; x++)
-						for(int y = 0; y < 2; y++)
-							for(int z = 0; z < 2; z++)
-							{
-								const FIntVector SourceCoord = (SourceBaseCoord + FIntVector(x,y,z)).ComponentMin(SourceTile.TileSize - FIntVector(1,1,1));
-								Values[x][y][z] = SourceTextureData[SourceTile.TileCoordToDataIndex(SourceCoord)];
-							}
-		
-					// Lerp in Z
-					if (Lerp.Z > 0)
-						for(int x = 0; x < 2; x++)
-							for(int y = 0; y < 2; y++)
-								Values[x][y][0] = FMath::Lerp(Values[x][y][0], Values[x][y][1], Lerp.Z);
-		
-					// Lerp in Y
-					if (Lerp.Y > 0)
-						for(int x = 0; x < 2; x++)
-							Values[x][0][0] = FMath::Lerp(Values[x][0][0], Values[x][1][0], Lerp.Y);
-		
-					// Lerp in X
-					if (Lerp.X > 0)
-						Values[0][0][0] = FMath::Lerp(Values[0][0][0], Values[1][0][0], Lerp.X);
-					
-					TextureData[Context.DataIndex] = Values[0][0][0];
-
-					Context.DataIndex += Tile.TileDataStepSize.X; // Next Pixel
+					const int64 Index = i * SourceStride.X + Channel - FirstChannel;
+					PlaneScratch[Index] = FMath::Lerp(Plane0[Index], Plane1[Index], TapZ.Lerp);
 				}
-				Context.DataIndex += Tile.TileDataStepSize.Y; // Next row
 			}
-			Context.DataIndex += Tile.TileDataStepSize.Z; // Next slice
+
+			Plane = PlaneScratch;
 		}
-	}
-	else
-	{
-		for (Context.TileCoord.Z = 0; Context.TileCoord.Z < Tile.TileSize.Z; Context.TileCoord.Z++)
+
+		for (int32 Y = 0; Y < Tile.TileSize.Y; Y++)
 		{
-			for (Context.TileCoord.Y = 0; Context.TileCoord.Y < Tile.TileSize.Y; Context.TileCoord.Y++)
+			const FAxisTaps& TapY = TapsY[Y];
+			const float* Row = Plane + TapY.Index0 * SourceStride.Y;
+
+			if (TapY.Lerp > 0)
+			{
+				const float* Row0 = Row;
+				const float* Row1 = Plane + TapY.Index1 * SourceStride.Y;
+
+				for (int32 X = 0; X < SourceTileSize.X; X++)
+				{
+					for (const int32 Channel : Channels)
+					{
+						const int64 Index = X * SourceStride.X + Channel - FirstChannel;
+						RowScratch[Index] = FMath::Lerp(Row0[Index], Row1[Index], TapY.Lerp);
+					}
+				}
+
+				Row = RowScratch;
+			}
+
+			float* DestRow = TextureData + Tile.TileCoordToDataIndex(FIntVector(0, Y, Z));
+
+			for (int32 X = 0; X < Tile.TileSize.X; X++)
 			{
-				Lerp.Y = CalulateInterp(Context.TileCoord.Y + Tile.TileOffset.Y, TargetSize.Y, SourceSize.Y);
+				const FAxisTaps& TapX = TapsX[X];
+				const float* Pixel0 = Row + TapX.Index0 * SourceStride.X - FirstChannel;
+				const float* Pixel1 = Row + TapX.Index1 * SourceStride.X - FirstChannel;
+				float* DestPixel = DestRow + X * Tile.TileDataStride.X;
 
-				for (Context.TileCoord.X = 0; Context.TileCoord.X < Tile.TileSize.X; Context.TileCoord.X++)
+				if (TapX.Lerp > 0)
+				{
+					for (const int32 Channel : Channels)
+						DestPixel[Channel] = FMath::Lerp(Pixel0[Channel], Pixel1[Channel], TapX.Lerp);
+				}
+				else
 				{
-					Lerp.X = CalulateInterp(Context.TileCoord.X + Tile.TileOffset.X, TargetSize.X, SourceSize.X);
-
-					const FIntVector SourceBaseCoord = TransformToSource(Context.TileCoord + Tile.TileOffset) - SourceTile.TileOffset;
-		
-					float Values[2][2];
-		
-					// Initialize values
-					for(int x = 0; x < 2; x++)
-						for(int y = 0; y < 2; y++)
-						{
-							const FIntVector SourceCoord = (SourceBaseCoord + FIntVector(x,y,0)).ComponentMin(SourceTile.TileSize - FIntVector(1,1,1));
-							Values[x][y] = SourceTextureData[SourceTile.TileCoordToDataIndex(SourceCoord)];
-						}
-		
-					// Lerp in Y
-					if (Lerp.Y > 0)
-						for(int x = 0; x < 2; x++)
-							Values[x][0] = FMath::Lerp(Values[x][0], Values[x][1], Lerp.Y);
-		
-					// Lerp in X
-					if (Lerp.X > 0)
-						Values[0][0] = FMath::Lerp(Values[0][0], Values[1][0], Lerp.X);
-					
-					TextureData[Context.DataIndex] = Values[0][0];
-
-					Context.DataIndex += Tile.TileDataStepSize.X; // Next Pixel
+					for (const int32 Channel : Channels)
+						DestPixel[Channel] = Pixel0[Channel];
 				}
-				Context.DataIndex += Tile.TileDataStepSize.Y; // Next row
 			}
-			Context.DataIndex += Tile.TileDataStepSize.Z; // Next slice
 		}
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#include "ProcessingNodes/TextureOperatorTileCache.h"
+
+bool FTextureTileCache::Read(const FKey& Key, const FTextureDataTileDesc& Tile, float* TextureData)
+{
+	FScopeLock Lock(&CS);
+
+	FEntry* Entry = Entries.Find(Key);
+
+	if (!Entry)
+	{
+		Misses++;
+		return false;
+	}
+
+	Entry->LastUse = ++UseCounter;
+	Hits++;
+
+	const float* CachedData = Entry->Data.GetData();
+	int64 i = 0;
+	Tile.ForEachPixel([TextureData, CachedData, &i](FTextureDataTileDesc::ForEachPixelContext& Context)
+	{
+		TextureData[Context.DataIndex] = CachedData[i++];
+	});
+
+	return true;
+}
+
+void FTextureTileCache::Write(const FKey& Key, const FTextureDataTileDesc& Tile, const float* TextureData)
+{
+	FEntry NewEntry;
+	NewEntry.Data.Reserve((int64)Tile.TileSize.X * Tile.TileSize.Y * Tile.TileSize.Z);
+
+	// Copy outside of the lock, tiles are stored packed regardless of the layout they were generated in
+	Tile.ForEachPixel([TextureData, &NewEntry](FTextureDataTileDesc::ForEachPixelContext& Context)
+	{
+		NewEntry.Data.Add(TextureData[Context.DataIndex]);
+	});
+
+	const int64 EntryBytes = NewEntry.Data.Num() * sizeof(float);
+
+	if (EntryBytes > MaxBytes)
+		return; // Would never fit
+
+	FScopeLock Lock(&CS);
+
+	if (Entries.Contains(Key))
+		return; // Another thread generated the same tile
+
+	if (UsedBytes + EntryBytes > MaxBytes)
+	{
+		// Evict down to 3/4 of the budget, so we don't have to search for the oldest entry on every write
+		Evict(FMath::Min(MaxBytes * 3 / 4, MaxBytes - EntryBytes));
+	}
+
+	NewEntry.LastUse = ++UseCounter;
+	Entries.Add(Key, MoveTemp(NewEntry));
+	UsedBytes += EntryBytes;
+}
+
+void FTextureTileCache::Remove(const void* Node)
+{
+	FScopeLock Lock(&CS);
+
+	for (auto It = Entries.CreateIterator(); It; ++It)
+	{
+		if (It.Key().Node == Node)
+		{
+			UsedBytes -= It.Value().Data.Num() * sizeof(float);
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FTextureTileCache::Evict(int64 TargetBytes)
+{
+	// Must be called with the lock held
+	TArray<TPair<uint64, FKey>> ByAge;
+	ByAge.Reserve(Entries.Num());
+
+	for (const auto& [Key, Entry] : Entries)
+		ByAge.Add({Entry.LastUse, Key});
+
+	ByAge.Sort([](const TPair<uint64, FKey>& A, const TPair<uint64, FKey>& B) { return A.Key < B.Key; });
+
+	for (const TPair<uint64, FKey>& Oldest : ByAge)
+	{
+		if (UsedBytes <= TargetBytes)
+			break;
+
+		UsedBytes -= Entries.FindChecked(Oldest.Value).Data.Num() * sizeof(float);
+		Entries.Remove(Oldest.Value);
+	}
+}
+
+void FTextureOperatorTileCache::Cache()
+{
+	FTextureOperator::Cache();
+
+	FScopeLock Lock(&CacheCS);
+	CacheRefCount++;
+}
+
+void FTextureOperatorTileCache::ReleaseCache()
+{
+	{
+		FScopeLock Lock(&CacheCS);
+		check(CacheRefCount > 0);
+
+		// Drop our tiles once nothing is going to ask for them again
+		if (--CacheRefCount == 0)
+			TileCache->Remove(this);
+	}
+
+	FTextureOperator::ReleaseCache();
+}
+
+void FTextureOperatorTileCache::WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const
+{
+	WriteChannels(1 << Channel, Tile.OffsetData(-Channel), TextureData);
+}
+
+void FTextureOperatorTileCache::WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const
+{
+	TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile);
+
+	uint8 MissingChannels = 0;
+
+	for (int32 Channel = 0; Channel < 4; Channel++)
+	{
+		if (!(ChannelMask & (1 << Channel)))
+			continue;
+
+		const FTextureTileCache::FKey Key = {this, Channel, Tile.TileOffset, Tile.TileSize};
+
+		if (!TileCache->Read(Key, Tile.OffsetData(Channel), TextureData))
+			MissingChannels |= 1 << Channel;
+	}
+
+	if (MissingChannels == 0)
+		return;
+
+	SourceImage->WriteChannels(MissingChannels, Tile, TextureData);
+
+	for (int32 Channel = 0; Channel < 4; Channel++)
+	{
+		if (MissingChannels & (1 << Channel))
+			TileCache->Write({this, Channel, Tile.TileOffset, Tile.TileSize}, Tile.OffsetData(Channel), TextureData);
+	}
+}
@@ -2,9 +2,23 @@
 
 #include "ProcessingNodes/TextureRead.h"
 
+#include "Async/ParallelFor.h"
+#include "ProcessingNodes/TextureSourceCache.h"
 #include "TextureSetProcessingGraph.h"
 #include "TextureSetsHelpers.h"
 
+static TAutoConsoleVariable<bool> CVarVectorizedSourceConversion(
+	TEXT("ts.VectorizedSourceConversion"),
+	true,
+	TEXT("Convert 8 bit, 16 bit and half float texture set sources to float a row at a time with vector instructions, rather than one value at a time.\n")
+	TEXT("Both paths produce identical data, so this doesn't affect the generated textures."));
+
+static TAutoConsoleVariable<bool> CVarValidateVectorizedSourceConversion(
+	TEXT("ts.VectorizedSourceConversion.Validate"),
+	false,
+	TEXT("Check every value converted by the vectorized source conversion against the scalar conversion, and assert if they aren't bitwise identical.\n")
+	TEXT("Slow, intended for verifying the conversion on a new platform or compiler."));
+
 FTextureRead::FTextureRead(FName SourceNameIn, const FTextureSetSourceTextureDef& SourceDefinitionIn)
 	: SourceName(SourceNameIn)
 	, SourceDefinition(SourceDefinitionIn)
@@ -15,6 +29,12 @@ FTextureRead::FTextureRead(FName SourceNameIn, const FTextureSetSourceTextureDef
 	, Width(1)
 	, Height(1)
 	, Slices(1)
+	, bPinnedSourceMip(false)
+	, ReadFormat(TSF_Invalid)
+	, ConvertedFormat(TSF_Invalid)
+	, ReadMip(0)
+	, DownsampleFactor(1)
+	, CacheRefCount(0)
 {
 }
 
@@ -75,6 +95,8 @@ void FTextureRead::Prepare(const FTextureSetProcessingContext& Context)
 	if (bPrepared)
 		return;
 
+	TEXTURESET_TRACE_NODE_SCOPE(Prepare);
+
 	if(Context.SourceTextures.Contains(SourceName))
 	{
 		const FTextureSetSourceTextureReference& TextureRef = Context.SourceTextures.FindChecked(SourceName);
@@ -86,6 +108,9 @@ void FTextureRead::Prepare(const FTextureSetProcessingContext& Context)
 			check(Texture->Source.IsValid());
 			AsyncSource = Texture->Source.CopyTornOff(); // This copies information required to make a safe IO load async.
 
+			if (!TextureSetsHelpers::GetSourceDataIdAsString(Texture, SourceDataId))
+				SourceDataId.Empty();
+
 			switch (AsyncSource.GetFormat())
 			{
 			case ETextureSourceFormat::TSF_G8:
@@ -131,24 +156,137 @@ void FTextureRead::Prepare(const FTextureSetProcessingContext& Context)
 			Slices = AsyncSource.GetNumSlices();
 			TextureSourceFormat = AsyncSource.GetFormat();
 			TextureSourceGamma = AsyncSource.GetGammaSpace(0);
+
+			const bool bHalfSource = TextureSourceFormat == TSF_R16F || TextureSourceFormat == TSF_RGBA16F;
+			if (ValidChannels == 1)
+				ConvertedFormat = bHalfSource ? TSF_R16F : TSF_R32F;
+			else
+				ConvertedFormat = bHalfSource ? TSF_RGBA16F : TSF_RGBA32F;
+
+			if (Context.MaxSourceSize > 0)
+			{
+				int32 Levels = 0;
+				while (FMath::Max(Width, Height) >> Levels > Context.MaxSourceSize)
+					Levels++;
+
+				if (Levels < AsyncSource.GetNumMips())
+				{
+					// Use the source's own mip where there is one, which avoids loading the top mip
+					ReadMip = Levels;
+					Width = FMath::Max(1, Width >> Levels);
+					Height = FMath::Max(1, Height >> Levels);
+				}
+				else
+				{
+					DownsampleFactor = 1 << Levels;
+					Width = FMath::DivideAndRoundUp(Width, DownsampleFactor);
+					Height = FMath::DivideAndRoundUp(Height, DownsampleFactor);
+				}
+			}
 		}
 	}
 
 	bPrepared = true;
 }
 
+uint8 FTextureRead::GetConstantChannels(FVector4f& OutValues) const
+{
+	check(bPrepared);
+
+	// Channels the source doesn't have (or all of them, if there is no source) are filled with the default value
+	uint8 ConstantMask = 0;
+
+	for (int32 Channel = AsyncSource.IsValid() ? ValidChannels : 0; Channel < 4; Channel++)
+	{
+		OutValues[Channel] = SourceDefinition.DefaultValue[Channel];
+		ConstantMask |= 1 << Channel;
+	}
+
+	return ConstantMask;
+}
+
 void FTextureRead::Cache()
 {
 	check(bPrepared); // Should not happen unless called out of order
 
-	if (AsyncSource.IsValid())
+	TEXTURESET_TRACE_NODE_SCOPE(Cache);
+	FScopeLock Lock(&CacheCS);
+
+	// Only load the mip for the first user, it's shared until the last user releases it
+	if (CacheRefCount++ == 0 && AsyncSource.IsValid())
 	{
-		// This version of GetMipData does not make any internal copies,
-		// and gives us read-only access to the internal shared buffer.
-		// According to the comments, the FSharedBuffer is ref counted
-		// so will remain valid as long as we need it
-		FTextureSource::FMipData MipData = AsyncSource.GetMipData(nullptr);
-		TextureSourceMip0 = MipData.GetMipData(0, 0, 0);
+		// Sources are stored on disk if enabled, so later compiles can map them instead of decompressing the source again.
+		// Only downsampled reads are converted to float. Otherwise the read is the source mip itself, which is the narrowest
+		// format that holds it exactly, so that's what gets stored.
+		const bool bUseDiskCache = !SourceDataId.IsEmpty() && FTextureSourceCache::IsDiskCacheEnabled();
+		const bool bConvert = DownsampleFactor > 1;
+		ReadFormat = bConvert ? ConvertedFormat : TextureSourceFormat;
+
+		const FString DiskCacheKey = FString::Printf(TEXT("%s_%i_%i_%i_%i"), *SourceDataId, ReadMip, DownsampleFactor, (int32)ReadFormat, (int32)TextureSourceGamma);
+		const uint64 ReadSize = (uint64)Width * Height * Slices * FTextureSource::GetBytesPerPixel(ReadFormat);
+
+		if (bUseDiskCache)
+			TextureSourceData = FTextureSourceCache::Get().FindOnDisk(DiskCacheKey, ReadSize);
+
+		if (TextureSourceData.IsNull())
+		{
+			// This version of GetMipData does not make any internal copies,
+			// and gives us read-only access to the internal shared buffer.
+			// According to the comments, the FSharedBuffer is ref counted
+			// so will remain valid as long as we need it
+			auto LoadMip = [this]()
+			{
+				FTextureSource::FMipData MipData = AsyncSource.GetMipData(nullptr);
+				FSharedBuffer Mip = MipData.GetMipData(0, 0, ReadMip);
+
+				// The mip is a view that keeps the whole bulk payload alive, so copy it out unless it is the whole payload
+				const bool bWholePayload = AsyncSource.GetNumMips() == 1 && AsyncSource.GetNumLayers() == 1 && AsyncSource.GetNumBlocks() == 1;
+				return bWholePayload ? Mip : FSharedBuffer::Clone(Mip);
+			};
+
+			// Decoded mips are shared with every other compilation reading the same source
+			const FTextureSourceCache::FKey CacheKey = { SourceDataId, ReadMip };
+			FSharedBuffer SourceMip = SourceDataId.IsEmpty() ? LoadMip() : FTextureSourceCache::Get().Acquire(CacheKey, LoadMip);
+
+			if (bConvert || bUseDiskCache)
+			{
+				// The source mip is only needed until it's been converted or stored, after which it's left for the cache to evict
+				TextureSourceData = bConvert ? ConvertSource(SourceMip) : SourceMip;
+
+				if (bUseDiskCache)
+					TextureSourceData = FTextureSourceCache::Get().StoreOnDisk(DiskCacheKey, TextureSourceData);
+
+				// Keep the pin if the mip itself is still what's being read, because it couldn't be stored and mapped
+				bPinnedSourceMip = !SourceDataId.IsEmpty() && TextureSourceData.GetData() == SourceMip.GetData();
+
+				if (!SourceDataId.IsEmpty() && !bPinnedSourceMip)
+					FTextureSourceCache::Get().Release(CacheKey);
+			}
+			else
+			{
+				TextureSourceData = SourceMip;
+				bPinnedSourceMip = !SourceDataId.IsEmpty();
+			}
+		}
+	}
+}
+
+void FTextureRead::ReleaseCache()
+{
+	FScopeLock Lock(&CacheCS);
+
+	check(CacheRefCount > 0); // Released more times than it was cached
+
+	// Don't keep the source mip alive for the rest of the compile once nothing needs it
+	if (--CacheRefCount == 0 && AsyncSource.IsValid())
+	{
+		TextureSourceData.Reset();
+
+		// Unpins the shared mip, which stays cached until it's evicted
+		if (bPinnedSourceMip)
+			FTextureSourceCache::Get().Release({ SourceDataId, ReadMip });
+
+		bPinnedSourceMip = false;
 	}
 }
 
@@ -332,14 +470,144 @@ namespace
 		}
 	}
 
+	// Describes a single channel to copy from the source data to the dest data.
+	struct FChannelCopy
+	{
+		int32 SourceOffset; // Offset of the channel within a pixel of the source data
+		int32 DestOffset; // Offset of the channel from the data index of the dest tile
+	};
+
+	template <typename TPixelType, typename ConvertFunc>
+	static void CopyChannels(const FTextureDataTileDesc& DestTile, const FTextureDataTileDesc& SourceTile, const TPixelType* SourceData, float* DestData, TConstArrayView<FChannelCopy> Copies, const ConvertFunc& Convert)
+	{
+		if (Copies.Num() == 1)
+		{
+			// Single channel, avoid the inner loop
+			const int32 SourceOffset = Copies[0].SourceOffset;
+			const int32 DestOffset = Copies[0].DestOffset;
+
+			IterateData(DestTile, SourceTile, [&DestData, &SourceData, &Convert, SourceOffset, DestOffset](int64 ISource, int64 IDest)
+			{
+				DestData[IDest + DestOffset] = Convert(SourceData[ISource + SourceOffset]);
+			});
+		}
+		else
+		{
+			// Multiple channels, so convert all requested channels of a pixel while it's in cache
+			IterateData(DestTile, SourceTile, [&DestData, &SourceData, &Convert, &Copies](int64 ISource, int64 IDest)
+			{
+				for (const FChannelCopy& Copy : Copies)
+					DestData[IDest + Copy.DestOffset] = Convert(SourceData[ISource + Copy.SourceOffset]);
+			});
+		}
+	}
+
+	// Converts a contiguous run of source values to float, several at a time where the platform has vector instructions.
+	// Every value must convert exactly as the matching scalar conversion in CopyImageData does.
+	static void ConvertRow(const uint8* Source, float* Dest, int32 Num, EGammaSpace GammaSpace)
+	{
+		if (GammaSpace == EGammaSpace::Linear)
+		{
+			// Divide rather than multiply by the reciprocal, so values round the same as the scalar path
+			const VectorRegister4Float Max = VectorSetFloat1(255.f);
+			int32 i = 0;
+
+			for (; i + 4 <= Num; i += 4)
+				VectorStore(VectorDivide(VectorLoadByte4(Source + i), Max), Dest + i);
+
+			for (; i < Num; i++)
+				Dest[i] = (float)Source[i] / 255.f;
+		}
+		else
+		{
+			// Contiguous table lookups, which are cheaper and exact compared to a gather or a polynomial
+			check(GammaSpace == EGammaSpace::sRGB || GammaSpace == EGammaSpace::Pow22);
+			const float* Table = GammaSpace == EGammaSpace::sRGB ? sRGBToLinearTable : Pow22OneOver255Table;
+
+			for (int32 i = 0; i < Num; i++)
+				Dest[i] = Table[Source[i]];
+		}
+	}
+
+	static void ConvertRow(const uint16* Source, float* Dest, int32 Num, EGammaSpace GammaSpace)
+	{
+		// Simple enough for the compiler to vectorize once the values are contiguous
+		for (int32 i = 0; i < Num; i++)
+			Dest[i] = (float)Source[i] / 65535.f;
+	}
+
+	static void ConvertRow(const FFloat16* Source, float* Dest, int32 Num, EGammaSpace GammaSpace)
+	{
+		static_assert(sizeof(FFloat16) == sizeof(uint16));
+		int32 i = 0;
+
+		// 8 values per instruction with F16C, or the platform's own half conversion otherwise
+		for (; i + 8 <= Num; i += 8)
+			FPlatformMath::WideLoadHalf((const uint16*)(Source + i), Dest + i);
+
+		for (; i < Num; i++)
+			Dest[i] = Source[i];
+	}
+
+	// Same as CopyChannels, but converts each row of source pixels as a whole with ConvertRow, and then copies the requested
+	// channels out of the converted row. Convert is only used to validate the result.
+	template <typename TPixelType, typename ConvertFunc>
+	static void CopyChannelsVectorized(const FTextureDataTileDesc& DestTile, const FTextureDataTileDesc& SourceTile, const TPixelType* SourceData, float* DestData, TConstArrayView<FChannelCopy> Copies, EGammaSpace GammaSpace, const ConvertFunc& Convert)
+	{
+		check(SourceTile.TileSize == DestTile.TileSize);
+
+		const int32 SourcePixelStride = (int32)SourceTile.TileDataStride.X;
+		const int64 DestPixelStride = DestTile.TileDataStride.X;
+		const int32 RowValues = SourceTile.TileSize.X * SourcePixelStride;
+		const bool bValidate = CVarValidateVectorizedSourceConversion.GetValueOnAnyThread();
+
+		TArray<float, TInlineAllocator<1024>> Row;
+		Row.SetNumUninitialized(RowValues);
+
+		for (int32 Z = 0; Z < DestTile.TileSize.Z; Z++)
+		{
+			for (int32 Y = 0; Y < DestTile.TileSize.Y; Y++)
+			{
+				// Pixels of a source row are always contiguous
+				const TPixelType* SourceRow = SourceData + SourceTile.TileCoordToDataIndex(FIntVector(0, Y, Z));
+				float* DestRow = DestData + DestTile.TileCoordToDataIndex(FIntVector(0, Y, Z));
+
+				ConvertRow(SourceRow, Row.GetData(), RowValues, GammaSpace);
+
+				for (int32 X = 0; X < DestTile.TileSize.X; X++)
+				{
+					const float* SourcePixel = Row.GetData() + X * SourcePixelStride;
+					float* DestPixel = DestRow + X * DestPixelStride;
+
+					for (const FChannelCopy& Copy : Copies)
+						DestPixel[Copy.DestOffset] = SourcePixel[Copy.SourceOffset];
+				}
+
+				if (bValidate)
+				{
+					for (int32 X = 0; X < DestTile.TileSize.X; X++)
+					{
+						for (const FChannelCopy& Copy : Copies)
+						{
+							const float Vectorized = DestRow[X * DestPixelStride + Copy.DestOffset];
+							const float Scalar = Convert(SourceRow[X * SourcePixelStride + Copy.SourceOffset]);
+							checkf(FMemory::Memcmp(&Vectorized, &Scalar, sizeof(float)) == 0,
+								TEXT("Vectorized source conversion differs from the scalar conversion (%.9g != %.9g)"), Vectorized, Scalar);
+						}
+					}
+				}
+			}
+		}
+	}
+
 	template<ETextureSourceFormat SourceFormat, typename TPixelType>
-	void CopyImageData(FSharedBuffer SourceBuffer, int SourceChannelIndex, EGammaSpace GammaSpace, const FTextureDataTileDesc& DestTile, float* DestData)
+	void CopyImageData(FSharedBuffer SourceBuffer, TConstArrayView<FChannelCopy> Copies, EGammaSpace GammaSpace, const FTextureDataTileDesc& DestTile, float* DestData)
 	{
 		const uint64 ExpectedSize = sizeof(TPixelType) * DestTile.TextureSize.X * DestTile.TextureSize.Y * DestTile.TextureSize.Z * GetPixelStride<SourceFormat>();
 		check(SourceBuffer.GetSize() == ExpectedSize);
 
-		const FIntVector3 DataStride = FTextureDataTileDesc::ComputeDataStrides(GetPixelStride<SourceFormat>(), DestTile.TextureSize);
-		const int32 DataOffset = FTextureDataTileDesc::ComputeDataOffset(DestTile.TileOffset, DataStride) + RemapChannel<SourceFormat>(SourceChannelIndex);
+		const FInt64Vector3 DataStride = FTextureDataTileDesc::ComputeDataStrides(GetPixelStride<SourceFormat>(), DestTile.TextureSize);
+		const int64 DataOffset = FTextureDataTileDesc::ComputeDataOffset(DestTile.TileOffset, DataStride);
 
 		const FTextureDataTileDesc SourceTile(
 			DestTile.TextureSize,
@@ -349,37 +617,48 @@ namespace
 			DataOffset
 		);
 
+		// Remap the source channel indices to the memory layout of the source format
+		TArray<FChannelCopy, TInlineAllocator<4>> RemappedCopies;
+		for (const FChannelCopy& Copy : Copies)
+			RemappedCopies.Add({ RemapChannel<SourceFormat>(Copy.SourceOffset), Copy.DestOffset });
+
 		const TPixelType* SourceData = (TPixelType*)SourceBuffer.GetData();
 
-		if constexpr (std::is_same<float, TPixelType>::value || std::is_same<FFloat16, TPixelType>::value)
+		// Converting whole rows also converts channels that weren't requested, so it's only worth it when at least half are.
+		// Float sources need no conversion, so they always take the scalar path, which is a plain copy.
+		constexpr bool bCanVectorize = !std::is_same<float, TPixelType>::value;
+		const bool bVectorized = bCanVectorize && RemappedCopies.Num() * 2 >= GetPixelStride<SourceFormat>() && CVarVectorizedSourceConversion.GetValueOnAnyThread();
+
+		auto Copy = [&](const auto& Convert)
 		{
-			IterateData(DestTile, SourceTile, [&DestData, &SourceData](int64 ISource, int64 IDest)
+			if constexpr (bCanVectorize)
 			{
-				DestData[IDest] = SourceData[ISource];
-			});
+				if (bVectorized)
+				{
+					CopyChannelsVectorized(DestTile, SourceTile, SourceData, DestData, RemappedCopies, GammaSpace, Convert);
+					return;
+				}
+			}
 
+			CopyChannels(DestTile, SourceTile, SourceData, DestData, RemappedCopies, Convert);
+		};
+
+		if constexpr (std::is_same<float, TPixelType>::value || std::is_same<FFloat16, TPixelType>::value)
+		{
+			Copy([](TPixelType Value) { return (float)Value; });
 		}
 		else if constexpr (std::is_same<uint8, TPixelType>::value)
 		{
 			switch (GammaSpace)
 			{
 			case EGammaSpace::Linear:
-				IterateData(DestTile, SourceTile, [&DestData, &SourceData](int64 ISource, int64 IDest)
-				{
-					DestData[IDest] = (float)SourceData[ISource] / 255.f;
-				});
+				Copy([](uint8 Value) { return (float)Value / 255.f; });
 				break;
 			case EGammaSpace::sRGB:
-				IterateData(DestTile, SourceTile, [&DestData, &SourceData](int64 ISource, int64 IDest)
-				{
-					DestData[IDest] = sRGBToLinearTable[SourceData[ISource]];
-				});
+				Copy([](uint8 Value) { return sRGBToLinearTable[Value]; });
 				break;
 			case EGammaSpace::Pow22:
-				IterateData(DestTile, SourceTile, [&DestData, &SourceData](int64 ISource, int64 IDest)
-				{
-					DestData[IDest] = Pow22OneOver255Table[SourceData[ISource]];
-				});
+				Copy([](uint8 Value) { return Pow22OneOver255Table[Value]; });
 				break;
 			default:
 				unimplemented()
@@ -388,71 +667,176 @@ namespace
 		}
 		else if constexpr (std::is_same<uint16, TPixelType>::value)
 		{
-			IterateData(DestTile, SourceTile, [&DestData, &SourceData](int64 ISource, int64 IDest)
-			{
-				DestData[IDest] = (float)SourceData[ISource] / 65535.f;
-			});
+			Copy([](uint16 Value) { return (float)Value / 65535.f; });
 		}
 		else
 		{
 			unimplemented()
 		}
-
-#undef ITERATE_DATA
 	}
-}
 
-void FTextureRead::WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const
-{
-	if (Channel < ValidChannels)
+	static void CopySourceData(ETextureSourceFormat Format, FSharedBuffer SourceBuffer, TConstArrayView<FChannelCopy> Copies, EGammaSpace GammaSpace, const FTextureDataTileDesc& DestTile, float* DestData)
 	{
-		check(!TextureSourceMip0.IsNull());
-		check(Tile.TextureSize.X == Width);
-		check(Tile.TextureSize.Y == Height);
-		check(Tile.TextureSize.Z == Slices);
-
-		const int SourceChannelIndex = ChannelSwizzle[Channel];
-
-		switch (TextureSourceFormat)
+		switch (Format)
 		{
 		case TSF_G8:
-			CopyImageData<TSF_G8, uint8>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_G8, uint8>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_BGRA8:
-			CopyImageData<TSF_BGRA8, uint8>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_BGRA8, uint8>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_BGRE8:
-			CopyImageData<TSF_BGRE8, uint8>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_BGRE8, uint8>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_RGBA16:
-			CopyImageData<TSF_RGBA16, uint16>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_RGBA16, uint16>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_RGBA16F:
-			CopyImageData<TSF_RGBA16F, FFloat16>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_RGBA16F, FFloat16>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_G16:
-			CopyImageData<TSF_G16, uint16>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_G16, uint16>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_RGBA32F:
-			CopyImageData<TSF_RGBA32F, float>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_RGBA32F, float>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_R16F:
-			CopyImageData<TSF_R16F, FFloat16>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_R16F, FFloat16>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		case TSF_R32F:
-			CopyImageData<TSF_R32F, float>(TextureSourceMip0, SourceChannelIndex, TextureSourceGamma, Tile, TextureData);
+			CopyImageData<TSF_R32F, float>(SourceBuffer, Copies, GammaSpace, DestTile, DestData);
 			break;
 		default:
 			unimplemented();
 			break;
 		}
 	}
-	else
+}
+
+void FTextureRead::WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const
+{
+	WriteChannels(1 << Channel, Tile.OffsetData(-Channel), TextureData);
+}
+
+void FTextureRead::WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const
+{
+	TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile);
+
+	TArray<FChannelCopy, TInlineAllocator<4>> Copies;
+
+	for (int32 Channel = 0; Channel < 4; Channel++)
 	{
-		// Fill tile data with default value
-		Tile.ForEachPixel([TextureData, Channel, this](FTextureDataTileDesc::ForEachPixelContext& Context)
+		if (!(ChannelMask & (1 << Channel)))
+			continue;
+
+		if (Channel < ValidChannels)
 		{
-			TextureData[Context.DataIndex] = SourceDefinition.DefaultValue[Channel];
-		});
+			Copies.Add({ ChannelSwizzle[Channel], Channel });
+		}
+		else
+		{
+			// Fill tile data with default value
+			const float DefaultValue = SourceDefinition.DefaultValue[Channel];
+			Tile.ForEachPixel([TextureData, Channel, DefaultValue](FTextureDataTileDesc::ForEachPixelContext& Context)
+			{
+				TextureData[Context.DataIndex + Channel] = DefaultValue;
+			});
+		}
 	}
+
+	if (Copies.IsEmpty())
+		return;
+
+	check(!TextureSourceData.IsNull());
+	check(Tile.TextureSize.X == Width);
+	check(Tile.TextureSize.Y == Height);
+	check(Tile.TextureSize.Z == Slices);
+
+	CopySourceData(ReadFormat, TextureSourceData, Copies, TextureSourceGamma, Tile, TextureData);
+}
+
+int64 FTextureRead::GetSourceMipSize() const
+{
+	check(bPrepared);
+
+	if (!AsyncSource.IsValid())
+		return 0;
+
+	// Converting holds both the loaded mip and the converted copy for a moment
+	const bool bConvert = DownsampleFactor > 1;
+	const int64 ConvertedSize = bConvert ? (int64)Width * Height * Slices * FTextureSource::GetBytesPerPixel(ConvertedFormat) : 0;
+	return AsyncSource.CalcMipSize(ReadMip) + ConvertedSize;
+}
+
+FSharedBuffer FTextureRead::ConvertSource(const FSharedBuffer& SourceMip) const
+{
+	const FIntVector3 SourceSize(FMath::Max(1, AsyncSource.GetSizeX() >> ReadMip), FMath::Max(1, AsyncSource.GetSizeY() >> ReadMip), Slices);
+	const bool bHalf = ConvertedFormat == TSF_R16F || ConvertedFormat == TSF_RGBA16F;
+	const int32 ElementSize = bHalf ? sizeof(FFloat16) : sizeof(float);
+
+	TArray<FChannelCopy, TInlineAllocator<4>> Copies;
+	for (int32 Channel = 0; Channel < ValidChannels; Channel++)
+		Copies.Add({ Channel, Channel });
+
+	FUniqueBuffer Converted = FUniqueBuffer::Alloc((uint64)Width * Height * Slices * ValidChannels * ElementSize);
+	uint8* DestData = (uint8*)Converted.GetData();
+
+	// Each destination row averages a band of DownsampleFactor source rows, converted to linear float so the filter is
+	// done in linear space. Blocks on the right and bottom edges may be partial, and only average the texels they cover.
+	ParallelFor(Height * Slices, [&](int32 Row)
+	{
+		const int32 Y = Row % Height;
+		const int32 Z = Row / Height;
+		const FIntVector3 BandOffset(0, Y * DownsampleFactor, Z);
+		const FIntVector3 BandSize(SourceSize.X, FMath::Min(DownsampleFactor, SourceSize.Y - BandOffset.Y), 1);
+
+		TArray64<float> Band;
+		Band.SetNumUninitialized((int64)BandSize.X * BandSize.Y * 4);
+
+		const FTextureDataTileDesc BandTile(SourceSize, BandSize, BandOffset, FTextureDataTileDesc::ComputeDataStrides(4, BandSize), 0);
+		CopySourceData(TextureSourceFormat, SourceMip, Copies, TextureSourceGamma, BandTile, Band.GetData());
+
+		const int64 RowStart = ((int64)Z * Height + Y) * Width * ValidChannels;
+
+		for (int32 X = 0; X < Width; X++)
+		{
+			const int32 X0 = X * DownsampleFactor;
+			const int32 X1 = FMath::Min(X0 + DownsampleFactor, SourceSize.X);
+			const float Weight = 1.0f / ((X1 - X0) * BandSize.Y);
+
+			for (int32 Channel = 0; Channel < ValidChannels; Channel++)
+			{
+				float Value;
+
+				if (DownsampleFactor == 1)
+				{
+					// Straight conversion, kept exact so the result matches reading the source directly
+					Value = Band[(int64)X * 4 + Channel];
+				}
+				else
+				{
+					float Sum = 0.0f;
+
+					for (int32 BY = 0; BY < BandSize.Y; BY++)
+					{
+						const float* BandRow = Band.GetData() + (int64)BY * BandSize.X * 4;
+
+						for (int32 BX = X0; BX < X1; BX++)
+							Sum += BandRow[BX * 4 + Channel];
+					}
+
+					Value = Sum * Weight;
+				}
+
+				const int64 DestIndex = RowStart + (int64)X * ValidChannels + Channel;
+
+				if (bHalf)
+					((FFloat16*)DestData)[DestIndex] = FFloat16(Value);
+				else
+					((float*)DestData)[DestIndex] = Value;
+			}
+		}
+	});
+
+	return Converted.MoveToShared();
 }
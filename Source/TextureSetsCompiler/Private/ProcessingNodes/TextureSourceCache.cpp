@@ -0,0 +1,363 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#include "ProcessingNodes/TextureSourceCache.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "TextureSetsHelpers.h"
+
+static TAutoConsoleVariable<int32> CVarSourceDataCacheSizeMB(
+	TEXT("ts.SourceDataCacheSizeMB"),
+	1024,
+	TEXT("Size in MB of the process wide cache of decoded source texture mips, shared by all texture set compilations.\n")
+	TEXT("Mips in use are always kept, this only bounds how many unused ones are kept around. 0 to disable."));
+
+static TAutoConsoleVariable<bool> CVarSourceDiskCache(
+	TEXT("ts.SourceDiskCache"),
+	false,
+	TEXT("Store decoded source textures on disk, and memory map them in later compilations instead of decompressing the\n")
+	TEXT("source again. Sources are stored in their own format and still converted to float when read, except for preview\n")
+	TEXT("downsamples, which are stored already converted. Trades disk space for compile time."));
+
+static TAutoConsoleVariable<FString> CVarSourceDiskCachePath(
+	TEXT("ts.SourceDiskCache.Path"),
+	TEXT(""),
+	TEXT("Directory of the source disk cache. Defaults to Saved/TextureSetSourceCache. Safe to delete at any time."));
+
+static TAutoConsoleVariable<int32> CVarSourceDiskCacheSizeMB(
+	TEXT("ts.SourceDiskCache.SizeMB"),
+	8192,
+	TEXT("Size in MB the source disk cache is trimmed to, deleting the least recently used files first. 0 for no limit."));
+
+namespace TextureSourceCacheImpl
+{
+	// Bump to invalidate all sources cached on disk
+	static const uint32 DiskCacheVersion = 2;
+	static const uint32 DiskCacheMagic = 0x43535354; // "TSSC"
+
+	// 16 bytes, so the mapped data stays aligned for float reads
+	struct FDiskCacheHeader
+	{
+		uint32 Magic;
+		uint32 Version;
+		uint64 DataSize;
+	};
+
+	static FString GetDiskCacheDirectory()
+	{
+		FString Directory = CVarSourceDiskCachePath.GetValueOnAnyThread();
+		if (Directory.IsEmpty())
+			Directory = FPaths::ProjectSavedDir() / TEXT("TextureSetSourceCache");
+
+		return Directory;
+	}
+
+	// The version is in the name, so files of other versions can be found without opening them
+	static FString GetDiskCacheSuffix()
+	{
+		return FString::Printf(TEXT("_v%u.tssc"), DiskCacheVersion);
+	}
+
+	static FString GetDiskCacheFilename(const FString& Key)
+	{
+		return GetDiskCacheDirectory() / FMD5::HashAnsiString(*Key) + GetDiskCacheSuffix();
+	}
+
+	static FSharedBuffer MapDiskCacheFile(const FString& Filename, uint64 ExpectedSize)
+	{
+		const uint64 FileSize = sizeof(FDiskCacheHeader) + ExpectedSize;
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+
+		if (PlatformFile.FileSize(*Filename) != (int64)FileSize)
+			return FSharedBuffer();
+
+		auto IsValidHeader = [ExpectedSize](const FDiskCacheHeader& Header)
+		{
+			return Header.Magic == DiskCacheMagic && Header.Version == DiskCacheVersion && Header.DataSize == ExpectedSize;
+		};
+
+		TSharedPtr<IMappedFileHandle> Handle(PlatformFile.OpenMapped(*Filename));
+		TSharedPtr<IMappedFileRegion> Region(Handle.IsValid() ? Handle->MapRegion(0, FileSize) : nullptr);
+
+		if (Region.IsValid())
+		{
+			const uint8* MappedData = Region->GetMappedPtr();
+
+			if (!IsValidHeader(*(const FDiskCacheHeader*)MappedData))
+				return FSharedBuffer();
+
+			// The buffer owns the mapping, and unmaps it once the last reference is gone. Regions must go before their file.
+			return FSharedBuffer::TakeOwnership(MappedData + sizeof(FDiskCacheHeader), ExpectedSize, [Handle, Region](void*) mutable
+			{
+				Region.Reset();
+				Handle.Reset();
+			});
+		}
+
+		// Platforms without memory mapping read the file instead
+		TArray64<uint8> FileData;
+		if (!FFileHelper::LoadFileToArray(FileData, *Filename) || FileData.Num() != (int64)FileSize || !IsValidHeader(*(const FDiskCacheHeader*)FileData.GetData()))
+			return FSharedBuffer();
+
+		return FSharedBuffer::Clone(FileData.GetData() + sizeof(FDiskCacheHeader), ExpectedSize);
+	}
+}
+
+static FAutoConsoleCommand CmdSourceDataCacheStats(
+	TEXT("ts.SourceDataCache.Stats"),
+	TEXT("Logs the hit rate and memory use of the decoded source texture cache."),
+	FConsoleCommandDelegate::CreateLambda([]() { FTextureSourceCache::Get().LogStats(); }));
+
+FTextureSourceCache& FTextureSourceCache::Get()
+{
+	static FTextureSourceCache Singleton;
+	return Singleton;
+}
+
+FSharedBuffer FTextureSourceCache::Acquire(const FKey& Key, TFunctionRef<FSharedBuffer()> Load)
+{
+	TSharedPtr<FEntry> Entry;
+	{
+		FScopeLock Lock(&CS);
+
+		TSharedRef<FEntry>* Found = Entries.Find(Key);
+		Entry = Found ? *Found : Entries.Add(Key, MakeShared<FEntry>());
+		Entry->Users++;
+		Entry->LastUse = ++UseCounter;
+	}
+
+	// Load outside of the cache lock, so loads of different mips don't wait on each other
+	FScopeLock LoadLock(&Entry->LoadCS);
+
+	if (!Entry->Data.IsNull())
+	{
+		Hits++;
+		return Entry->Data;
+	}
+
+	Misses++;
+	FSharedBuffer Data = Load();
+
+	FScopeLock Lock(&CS);
+	Entry->Data = Data;
+	UsedBytes += Data.GetSize();
+
+	const int64 MaxBytes = (int64)CVarSourceDataCacheSizeMB.GetValueOnAnyThread() * 1024 * 1024;
+	if (UsedBytes > MaxBytes)
+		Evict(MaxBytes);
+
+	return Data;
+}
+
+void FTextureSourceCache::Release(const FKey& Key)
+{
+	FScopeLock Lock(&CS);
+
+	TSharedRef<FEntry>& Entry = Entries.FindChecked(Key);
+	check(Entry->Users > 0); // Released more times than it was acquired
+	Entry->Users--;
+
+	const int64 MaxBytes = (int64)CVarSourceDataCacheSizeMB.GetValueOnAnyThread() * 1024 * 1024;
+	if (UsedBytes > MaxBytes)
+		Evict(MaxBytes);
+}
+
+void FTextureSourceCache::Evict(int64 MaxBytes)
+{
+	// Only unpinned entries can go, anything in use stays regardless of the budget
+	TArray<TPair<uint64, FKey>> ByAge;
+
+	for (const auto& [Key, Entry] : Entries)
+	{
+		if (Entry->Users == 0)
+			ByAge.Add({Entry->LastUse, Key});
+	}
+
+	ByAge.Sort([](const TPair<uint64, FKey>& A, const TPair<uint64, FKey>& B) { return A.Key < B.Key; });
+
+	for (const TPair<uint64, FKey>& Oldest : ByAge)
+	{
+		if (UsedBytes <= MaxBytes)
+			break;
+
+		UsedBytes -= Entries.FindChecked(Oldest.Value)->Data.GetSize();
+		Entries.Remove(Oldest.Value);
+		Evictions++;
+	}
+}
+
+bool FTextureSourceCache::IsDiskCacheEnabled()
+{
+	return CVarSourceDiskCache.GetValueOnAnyThread();
+}
+
+FSharedBuffer FTextureSourceCache::FindOnDisk(const FString& Key, uint64 ExpectedSize)
+{
+	ScanDiskCache();
+
+	const FString Filename = TextureSourceCacheImpl::GetDiskCacheFilename(Key);
+	FSharedBuffer Data = TextureSourceCacheImpl::MapDiskCacheFile(Filename, ExpectedSize);
+
+	if (Data.IsNull())
+	{
+		DiskCacheMisses++;
+	}
+	else
+	{
+		// Access times aren't updated reliably by every file system, so hits are stamped for trimming to find
+		IFileManager::Get().SetTimeStamp(*Filename, FDateTime::UtcNow());
+		DiskCacheHits++;
+	}
+
+	return Data;
+}
+
+void FTextureSourceCache::ScanDiskCache()
+{
+	FScopeLock Lock(&DiskCacheCS);
+
+	if (!bDiskCacheScanned)
+	{
+		TrimDiskCache();
+		bDiskCacheScanned = true;
+	}
+}
+
+void FTextureSourceCache::TrimDiskCache()
+{
+	using namespace TextureSourceCacheImpl;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString Suffix = GetDiskCacheSuffix();
+	// Temporary files this old were left behind by a writer that didn't finish
+	const FDateTime StaleTempTime = FDateTime::UtcNow() - FTimespan::FromHours(1);
+
+	struct FDiskCacheFile
+	{
+		FString Filename;
+		FDateTime LastUse;
+		int64 Size;
+	};
+
+	TArray<FDiskCacheFile> Files;
+	DiskCacheBytes = 0;
+
+	PlatformFile.IterateDirectoryStat(*GetDiskCacheDirectory(), [&](const TCHAR* Filename, const FFileStatData& StatData)
+	{
+		const FStringView Name(Filename);
+
+		if (StatData.bIsDirectory)
+			return true;
+
+		if (Name.EndsWith(Suffix))
+		{
+			Files.Add({Filename, FMath::Max(StatData.AccessTime, StatData.ModificationTime), StatData.FileSize});
+			DiskCacheBytes += StatData.FileSize;
+		}
+		else if (Name.EndsWith(TEXT(".tssc")) || (Name.EndsWith(TEXT(".tmp")) && StatData.ModificationTime < StaleTempTime))
+		{
+			// Files of older versions can never be read again
+			PlatformFile.DeleteFile(Filename);
+		}
+
+		return true;
+	});
+
+	const int64 MaxBytes = (int64)CVarSourceDiskCacheSizeMB.GetValueOnAnyThread() * 1024 * 1024;
+	if (MaxBytes <= 0 || DiskCacheBytes <= MaxBytes)
+		return;
+
+	// Trim a little below the limit, so the next few stores don't each have to scan the directory again
+	const int64 TargetBytes = MaxBytes - MaxBytes / 8;
+	Files.Sort([](const FDiskCacheFile& A, const FDiskCacheFile& B) { return A.LastUse < B.LastUse; });
+
+	for (const FDiskCacheFile& File : Files)
+	{
+		if (DiskCacheBytes <= TargetBytes)
+			break;
+
+		// Files still mapped by a compilation can fail to delete on some platforms, and are left for the next trim
+		if (PlatformFile.DeleteFile(*File.Filename))
+		{
+			DiskCacheBytes -= File.Size;
+			DiskCacheEvictions++;
+		}
+	}
+}
+
+FSharedBuffer FTextureSourceCache::StoreOnDisk(const FString& Key, const FSharedBuffer& Data)
+{
+	using namespace TextureSourceCacheImpl;
+
+	ScanDiskCache();
+
+	const FString Filename = GetDiskCacheFilename(Key);
+
+	// Written to a temporary file and moved into place, so concurrent compilations and editor instances never map a partial file
+	const FString TempFilename = FString::Printf(TEXT("%s.%s.tmp"), *Filename, *FGuid::NewGuid().ToString());
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempFilename));
+
+	if (!Writer)
+		return Data;
+
+	FDiskCacheHeader Header = { DiskCacheMagic, DiskCacheVersion, Data.GetSize() };
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Serialize((void*)Data.GetData(), Data.GetSize());
+	const bool bWritten = Writer->Close();
+	Writer.Reset();
+
+	// Losing the race to another writer is fine, it wrote the same data
+	if (!bWritten || !IFileManager::Get().Move(*Filename, *TempFilename, false))
+	{
+		IFileManager::Get().Delete(*TempFilename);
+		return Data;
+	}
+
+	{
+		FScopeLock Lock(&DiskCacheCS);
+		DiskCacheBytes += sizeof(Header) + Data.GetSize();
+
+		const int64 MaxBytes = (int64)CVarSourceDiskCacheSizeMB.GetValueOnAnyThread() * 1024 * 1024;
+		if (MaxBytes > 0 && DiskCacheBytes > MaxBytes)
+			TrimDiskCache();
+	}
+
+	// Map what was just written, so the data is paged from disk rather than held in memory
+	FSharedBuffer Mapped = MapDiskCacheFile(Filename, Data.GetSize());
+	return Mapped.IsNull() ? Data : Mapped;
+}
+
+void FTextureSourceCache::LogStats() const
+{
+	const int64 NumHits = Hits;
+	const int64 NumMisses = Misses;
+	const int64 Total = NumHits + NumMisses;
+
+	FScopeLock Lock(&CS);
+
+	int32 NumPinned = 0;
+	for (const auto& [Key, Entry] : Entries)
+	{
+		if (Entry->Users > 0)
+			NumPinned++;
+	}
+
+	UE_LOG(LogTextureSet, Log, TEXT("Source data cache: %lld hits, %lld misses (%.1f%% hit rate), %lld evictions. %i mips cached (%i in use), using %lldMB of %iMB."),
+		NumHits, NumMisses, Total > 0 ? 100.0 * NumHits / Total : 0.0, Evictions.load(), Entries.Num(), NumPinned,
+		UsedBytes / (1024 * 1024), CVarSourceDataCacheSizeMB.GetValueOnAnyThread());
+
+	if (IsDiskCacheEnabled())
+	{
+		const int64 NumDiskCacheHits = DiskCacheHits;
+		const int64 NumDiskCacheTotal = NumDiskCacheHits + DiskCacheMisses;
+		FScopeLock DiskCacheLock(&DiskCacheCS);
+		UE_LOG(LogTextureSet, Log, TEXT("Source disk cache: %lld hits, %lld misses (%.1f%% hit rate), %lld files trimmed. Using %lldMB of %iMB on disk."),
+			NumDiskCacheHits, NumDiskCacheTotal - NumDiskCacheHits, NumDiskCacheTotal > 0 ? 100.0 * NumDiskCacheHits / NumDiskCacheTotal : 0.0,
+			DiskCacheEvictions.load(), DiskCacheBytes / (1024 * 1024), CVarSourceDiskCacheSizeMB.GetValueOnAnyThread());
+	}
+}
@@ -3,17 +3,262 @@
 #include "TextureSetCompiler.h"
 
 #include "Async/ParallelFor.h"
+#include "Compression/CompressedBuffer.h"
 #include "DerivedDataBuildVersion.h"
-#include "DerivedDataCacheInterface.h"
+#include "DerivedDataCache.h"
+#include "DerivedDataCacheKey.h"
+#include "DerivedDataRequestOwner.h"
+#include "DerivedDataValue.h"
+#include "IO/IoHash.h"
+#include "Memory/CompositeBuffer.h"
+#include "ProcessingNodes/TextureInput.h"
 #include "ProcessingNodes/TextureOperatorEnlarge.h"
+#include "ProcessingNodes/TextureOperatorTileCache.h"
+#include "ProcessingNodes/TextureRead.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 #include "TextureSetDerivedData.h"
+#include "TextureSetEncoding.h"
 #include "TextureSetsHelpers.h"
 
+#include <atomic>
+
 #define BENCHMARK_TEXTURESET_COMPILATION 1
 
+static TAutoConsoleVariable<int32> CVarMaxParallelTilesPerCompile(
+	TEXT("ts.MaxParallelTilesPerCompile"),
+	0,
+	TEXT("Maximum number of tiles a single texture set compilation will process in parallel. 0 is unlimited, 1 processes tiles serially."));
+
+static TAutoConsoleVariable<bool> CVarFastGammaEncode(
+	TEXT("ts.FastGammaEncode"),
+	false,
+	TEXT("Use a vectorized polynomial approximation of the sRGB gamma encode when generating texture sets, instead of the exact Pow.\n")
+	TEXT("Max absolute error of the approximation is 7.2e-7 for values in [0, 1]. Changing this invalidates generated textures.\n")
+	TEXT("Intended to be set per-project in the [ConsoleVariables] section of DefaultEngine.ini."));
+
+static TAutoConsoleVariable<int32> CVarGenerationBandHeight(
+	TEXT("ts.GenerationBandHeight"),
+	0,
+	TEXT("When greater than 0, texture sets are generated in horizontal bands of (at least) this many rows, finishing each band before starting the next.\n")
+	TEXT("Keeps the data being worked on at any time proportional to the band size rather than the texture size. 0 generates the whole texture at once."));
+
+static TAutoConsoleVariable<int32> CVarTileCacheBudgetKB(
+	TEXT("ts.TileCacheBudgetKB"),
+	256,
+	TEXT("Size in KB that the working set of a single tile should fit in when choosing the tile size automatically.\n")
+	TEXT("Roughly the per-core L2 cache size of the machines compiling texture sets."));
+
+static TAutoConsoleVariable<int32> CVarTileCacheSizeMB(
+	TEXT("ts.TileCacheSizeMB"),
+	0,
+	TEXT("Size in MB of a per-compilation cache of the tiles generated by each output of the processing graph.\n")
+	TEXT("Avoids re-evaluating the graph when the same tiles are requested more than once. 0 disables the cache."));
+
+static TAutoConsoleVariable<bool> CVarChannelCache(
+	TEXT("ts.ChannelCache"),
+	false,
+	TEXT("Cache the generated data of each packed channel in the DDC, keyed by the hash of the processed texture channel that produced it.\n")
+	TEXT("When a packed texture has to be rebuilt, only the channels whose inputs changed are regenerated, and the rest are copied from the cache.\n")
+	TEXT("Costs an extra DDC lookup per rebuilt texture, and stores each generated texture a second time, so it's only worth it for iterating on sets\n")
+	TEXT("where a few channels change at a time."));
+
+static TAutoConsoleVariable<bool> CVarSourceCache(
+	TEXT("ts.SourceCache"),
+	false,
+	TEXT("Store generated texture sources in the DDC (in the texture source format, Oodle compressed) under their texture data ID,\n")
+	TEXT("and fetch them instead of regenerating them. Logs the time saved by each fetch, and the bytes stored."));
+
+static TAutoConsoleVariable<float> CVarSourceCacheMinSeconds(
+	TEXT("ts.SourceCache.MinSeconds"),
+	0.5f,
+	TEXT("Only texture sources which took at least this long to generate are stored by ts.SourceCache.\n")
+	TEXT("Cheap graphs are faster to regenerate than to fetch and decompress."));
+
+namespace TextureSetCompilerImpl
+{
+	static int64 GetTileCacheBudget()
+	{
+		return (int64)FMath::Max(CVarTileCacheBudgetKB.GetValueOnAnyThread(), 1) * 1024;
+	}
+
+	template <typename T>
+	static void CopyInterleavedElements(const T* Source, int32 SourceStride, T* Dest, int32 DestStride, int64 NumPixels)
+	{
+		for (int64 i = 0; i < NumPixels; i++)
+			Dest[i * DestStride] = Source[i * SourceStride];
+	}
+
+	// Copies one element per pixel between two buffers with different numbers of elements per pixel
+	static void CopyInterleavedElements(const uint8* Source, int32 SourceStride, uint8* Dest, int32 DestStride, int32 ElementSize, int64 NumPixels)
+	{
+		switch (ElementSize)
+		{
+		case 1: CopyInterleavedElements(Source, SourceStride, Dest, DestStride, NumPixels); break;
+		case 2: CopyInterleavedElements((const uint16*)Source, SourceStride, (uint16*)Dest, DestStride, NumPixels); break;
+		case 4: CopyInterleavedElements((const uint32*)Source, SourceStride, (uint32*)Dest, DestStride, NumPixels); break;
+		default: unimplemented();
+		}
+	}
+
+	// Cached data of a single packed channel, as stored in the channel cache (before compression)
+	struct FChannelCacheHeader
+	{
+		float RestoreMul;
+		float RestoreAdd;
+	};
+
+	static UE::DerivedData::FCacheKey MakeChannelCacheKey(const FGuid& ChannelDataId)
+	{
+		static const UE::DerivedData::FCacheBucket ChannelBucket(TEXT("TextureSetChannel"));
+		static const TCHAR* Version = TEXT("5B3E2F0A-6C1D-4E8B-9A47-2D6F1C8E3B90"); // Bump this to invalidate all cached channels
+
+		FIoHashBuilder HashBuilder;
+		HashBuilder.Update(Version, FCString::Strlen(Version) * sizeof(TCHAR));
+		HashBuilder.Update(&ChannelDataId, sizeof(FGuid));
+		return {ChannelBucket, HashBuilder.Finalize()};
+	}
+
+	static UE::DerivedData::FCacheKey MakeSourceCacheKey(const FGuid& TextureDataId)
+	{
+		static const UE::DerivedData::FCacheBucket SourceBucket(TEXT("TextureSetSource"));
+		static const TCHAR* Version = TEXT("A1C4E7F2-3B6D-4F80-8E25-7C9A0D1B4E64"); // Bump this to invalidate all cached sources
+
+		FIoHashBuilder HashBuilder;
+		HashBuilder.Update(Version, FCString::Strlen(Version) * sizeof(TCHAR));
+		HashBuilder.Update(&TextureDataId, sizeof(FGuid));
+		return {SourceBucket, HashBuilder.Finalize()};
+	}
+
+	// Lookups of a packed texture in the generation caches, in the UserData of its requests
+	static constexpr int32 GenerationCacheSlots = 5; // One per packed channel, then the source
+	static constexpr int32 SourceCacheSlot = 4;
+
+	// Memory held by a generated packed texture: its source, plus a compressed copy of it (or of its channels) for the
+	// DDC, which is at most the same size. Range compressed channels are also held as float planes until the range of the
+	// whole image is known.
+	static int64 EstimateGeneratedMemory(const FTextureSetPackingInfo& PackingInfo, int Index, const FIntVector3& Size)
+	{
+		const ETextureSourceFormat Format = TextureSetEncoding::ChooseSourceFormat(PackingInfo.GetPackedTextureDef(Index), PackingInfo.GetPackedTextureInfo(Index));
+		const int64 NumPixels = (int64)Size.X * Size.Y * Size.Z;
+		int64 Bytes = 2 * NumPixels * FTextureSource::GetBytesPerPixel(Format);
+
+		const FTextureSetPackedTextureInfo TextureInfo = PackingInfo.GetPackedTextureInfo(Index);
+		for (int c = 0; c < FMath::Min(TextureInfo.ChannelCount, TextureSetEncoding::GetSourceFormatChannels(Format)); c++)
+		{
+			if (TextureInfo.ChannelInfo[c].ChannelEncoding & (uint8)ETextureSetChannelEncoding::RangeCompression)
+				Bytes += NumPixels * sizeof(float);
+		}
+
+		return Bytes;
+	}
+
+	// Graph intermediates are per tile, and tiles are sized to fit the cache budget (scratch data, plus node temporaries
+	// like the enlarged source tile) on each worker. The tile cache is bounded by its own budget.
+	static int64 EstimateIntermediateMemory()
+	{
+		const int64 NumWorkers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+		int64 Bytes = NumWorkers * 2 * GetTileCacheBudget();
+
+		const int32 TileCacheSizeMB = CVarTileCacheSizeMB.GetValueOnAnyThread();
+		if (TileCacheSizeMB > 0)
+			Bytes += (int64)TileCacheSizeMB * 1024 * 1024;
+
+		return Bytes;
+	}
+
+	// Running totals for the source cache, logged with each fetch and store
+	static std::atomic<int64> SourceCacheMicrosecondsSaved = 0;
+	static std::atomic<int64> SourceCacheBytesStored = 0;
+
+	// Picks a tile size from the combined hints of the nodes being generated. Unspecified axes of the hint fall back to a
+	// square tile, which is then shrunk until the working set of a tile fits in the cache budget, and there are enough
+	// tiles to keep all worker threads busy. Rows are split last, since they are contiguous in memory.
+	static FIntVector3 ChooseTileSize(const FIntVector3& Hint, const FIntVector3& TextureSize, int64 BytesPerPixel, int64 CacheBudget)
+	{
+		const FIntVector3 DefaultTileSize(128, 128, 1);
+
+		FIntVector3 TileSize(
+			Hint.X > 0 ? Hint.X : DefaultTileSize.X,
+			Hint.Y > 0 ? Hint.Y : DefaultTileSize.Y,
+			Hint.Z > 0 ? Hint.Z : DefaultTileSize.Z
+		);
+		TileSize = TileSize.ComponentMin(TextureSize).ComponentMax(FIntVector3(1, 1, 1));
+
+		auto TileBytes = [&]() { return (int64)TileSize.X * TileSize.Y * TileSize.Z * BytesPerPixel; };
+
+		auto Shrink = [&TileSize]()
+		{
+			if (TileSize.Z > 1)
+				TileSize.Z = FMath::DivideAndRoundUp(TileSize.Z, 2);
+			else if (TileSize.Y > 1)
+				TileSize.Y = FMath::DivideAndRoundUp(TileSize.Y, 2);
+			else if (TileSize.X > 1)
+				TileSize.X = FMath::DivideAndRoundUp(TileSize.X, 2);
+			else
+				return false;
+			return true;
+		};
+
+		while (TileBytes() > CacheBudget && Shrink()) {}
+
+		const int32 MinTiles = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+		auto NumTiles = [&]() { const FIntVector3 N = FIntVector3::DivideAndRoundUp(TextureSize, TileSize); return N.X * N.Y * N.Z; };
+
+		// Don't split tiles below a row of 16 pixels just to create more parallel work
+		while (NumTiles() < MinTiles && TileSize.X * TileSize.Y * TileSize.Z > 16 && Shrink()) {}
+
+		return TileSize;
+	}
+
+	// Most work items ParallelForTiles should run at once. Read once per texture and passed to ParallelForTiles, so buffers
+	// sized from it stay valid if ts.MaxParallelTilesPerCompile changes mid-compile.
+	static int32 GetNumTileWorkers()
+	{
+		const int32 MaxParallel = CVarMaxParallelTilesPerCompile.GetValueOnAnyThread();
+		const int32 NumWorkers = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1; // Workers and the calling thread
+
+		return MaxParallel > 0 ? FMath::Min(MaxParallel, NumWorkers) : NumWorkers;
+	}
+
+	// Executes Body for each work item in parallel, limited to MaxWorkers concurrent items (see GetNumTileWorkers()).
+	// Work items must write to disjoint memory so that the result doesn't depend on the order they are executed in.
+	// Body also gets the index of the worker running it, below MaxWorkers, so it can reuse per-worker buffers.
+	static void ParallelForTiles(int32 NumItems, int32 MaxWorkers, TFunctionRef<void(int32 Item, int32 Worker)> Body)
+	{
+		// Each worker pulls the next item until none are left, which balances cheap and expensive items
+		const int32 NumWorkers = FMath::Min(MaxWorkers, NumItems);
+		std::atomic<int32> NextItem = 0;
+
+		ParallelFor(NumWorkers, [NumItems, &NextItem, &Body](int32 Worker)
+		{
+			for (int32 i = NextItem++; i < NumItems; i = NextItem++)
+				Body(i, Worker);
+		});
+	}
+
+	// Executes Body for each (tile, work item) pair, one band of consecutive tiles at a time.
+	// All work in a band completes before the next band starts; work within a band runs in parallel.
+	static void ParallelForTileBands(int32 NumTiles, int32 TilesPerBand, int32 WorkPerTile, int32 MaxWorkers, TFunctionRef<void(int32 Tile, int32 WorkItem, int32 Worker)> Body)
+	{
+		check(TilesPerBand > 0);
+
+		for (int32 FirstTile = 0; FirstTile < NumTiles; FirstTile += TilesPerBand)
+		{
+			const int32 BandTiles = FMath::Min(TilesPerBand, NumTiles - FirstTile);
+
+			ParallelForTiles(BandTiles * WorkPerTile, MaxWorkers, [FirstTile, BandTiles, &Body](int32 Index, int32 Worker)
+			{
+				Body(FirstTile + Index % BandTiles, Index / BandTiles, Worker);
+			});
+		}
+	}
+}
+
 FTextureSetCompiler::FTextureSetCompiler(TSharedRef<const FTextureSetCompilerArgs> Args)
 	: Args(Args)
 	, bPrepared(false)
+	, bFastGammaEncode(CVarFastGammaEncode.GetValueOnAnyThread())
 {
 	check(IsInGameThread());
 
@@ -23,10 +268,37 @@ FTextureSetCompiler::FTextureSetCompiler(TSharedRef<const FTextureSetCompilerArg
 	Context.SourceTextures = Args->SourceTextures;
 	Context.AssetParams = Args->AssetParams;
 	Context.Graph = GraphInstance;
+	Context.MaxSourceSize = Args->PreviewMaxSize;
 
 	CachedDerivedTextureIds.SetNum(Args->PackingInfo.NumPackedTextures());
 }
 
+void FTextureSetCompiler::Cancel()
+{
+	bCancelled = true;
+
+	FScopeLock Lock(&RequestOwnersCS);
+	for (UE::DerivedData::FRequestOwner* Owner : RequestOwners)
+		Owner->Cancel();
+}
+
+void FTextureSetCompiler::WaitForRequests(UE::DerivedData::FRequestOwner& Owner) const
+{
+	{
+		FScopeLock Lock(&RequestOwnersCS);
+		RequestOwners.Add(&Owner);
+	}
+
+	// Checked after registering, so a cancel either sees the owner or is seen here
+	if (IsCancelled())
+		Owner.Cancel();
+
+	Owner.Wait();
+
+	FScopeLock Lock(&RequestOwnersCS);
+	RequestOwners.RemoveSingleSwap(&Owner);
+}
+
 bool FTextureSetCompiler::CompilationRequired(UTextureSetDerivedData* ExistingDerivedData) const
 {
 	if (ExistingDerivedData == nullptr)
@@ -119,10 +391,18 @@ FGuid FTextureSetCompiler::ComputeTextureDataId(int PackedTextureIndex) const
 
 	UE::DerivedData::FBuildVersionBuilder IdBuilder;
 
-	IdBuilder << FString("TextureSetDerivedTexture_V0.22"); // Version string, bump this to invalidate everything
+	IdBuilder << FString("TextureSetDerivedTexture_V0.25"); // Version string, bump this to invalidate everything
 	IdBuilder << Args->UserKey; // Key for debugging, easily force rebuild
 	IdBuilder << GetTypeHash(Args->PackingInfo.GetPackedTextureDef(PackedTextureIndex));
 
+	IdBuilder << (uint8)GetTextureSourceFormat(PackedTextureIndex);
+
+	if (bFastGammaEncode)
+		IdBuilder << FString("FastGammaEncode"); // Approximated encoding produces slightly different data
+
+	if (IsPreview())
+		IdBuilder << FString::Printf(TEXT("Preview%i"), Args->PreviewMaxSize); // Must never share a key with the full resolution data
+
 	TSet<FName> TextureDependencies;
 	for (const FTextureSetPackedChannelInfo& ChannelInfo : Args->PackingInfo.GetPackedTextureInfo(PackedTextureIndex).ChannelInfo)
 	{
@@ -149,11 +429,37 @@ FGuid FTextureSetCompiler::ComputeParameterDataId(const TSharedRef<IParameterPro
 	UE::DerivedData::FBuildVersionBuilder IdBuilder;
 	IdBuilder << FString("TextureSetParameter_V0.7"); // Version string, bump this to invalidate everything
 	IdBuilder << Args->UserKey; // Key for debugging, easily force rebuild
+	if (IsPreview())
+		IdBuilder << FString::Printf(TEXT("Preview%i"), Args->PreviewMaxSize);
 	Parameter->ComputeGraphHash(IdBuilder);
 	Parameter->ComputeDataHash(Context, IdBuilder);
 	return IdBuilder.Build();
 }
 
+FGuid FTextureSetCompiler::ComputeChannelDataId(int PackedTextureIndex, int Channel, const FIntVector3& TextureSize) const
+{
+	const FTextureSetPackedTextureInfo& TextureInfo = Args->PackingInfo.GetPackedTextureInfo(PackedTextureIndex);
+	const FTextureSetPackedChannelInfo& ChannelInfo = TextureInfo.ChannelInfo[Channel];
+	const ETextureSourceFormat Format = GetTextureSourceFormat(PackedTextureIndex);
+
+	UE::DerivedData::FBuildVersionBuilder IdBuilder;
+	IdBuilder << FString("TextureSetDerivedChannel_V0.1"); // Version string, bump this to invalidate everything
+	IdBuilder << Args->UserKey; // Key for debugging, easily force rebuild
+	IdBuilder << OutputTextureDataIds.FindChecked(ChannelInfo.ProcessedTexture);
+	IdBuilder << ChannelInfo.ProessedTextureChannel;
+	IdBuilder << ChannelInfo.ChannelEncoding;
+	// Channels are gamma encoded in the shader unless hardware sRGB is used, which is never the case for alpha
+	IdBuilder << (TextureInfo.HardwareSRGB && Channel < 3);
+	IdBuilder << (uint8)Format;
+	IdBuilder << TextureSetEncoding::GetSourceFormatChannelIndex(Format, Channel);
+	IdBuilder << TextureSize.X << TextureSize.Y << TextureSize.Z;
+
+	if (bFastGammaEncode)
+		IdBuilder << FString("FastGammaEncode"); // Approximated encoding produces slightly different data
+
+	return IdBuilder.Build();
+}
+
 void FTextureSetCompiler::Prepare()
 {
 	// May need to create UObjects, so has to execute in game thread
@@ -169,6 +475,18 @@ void FTextureSetCompiler::Prepare()
 	for (const auto& [Name, ParameterNode] : GraphInstance->GetOutputParameters())
 		GetParameterDataId(Name);
 
+	// Processed texture hashes are the basis of the channel cache keys, which are computed during generation
+	for (const auto& [Name, TextureNode] : GraphInstance->GetOutputTextures())
+	{
+		UE::DerivedData::FBuildVersionBuilder IdBuilder;
+		TextureNode->ComputeGraphHash(IdBuilder);
+		TextureNode->ComputeDataHash(Context, IdBuilder);
+		OutputTextureDataIds.Add(Name, IdBuilder.Build());
+	}
+
+	// Share nodes between inputs that read the same source data. This changes graph hashes, so must happen after the IDs are primed.
+	GraphInstance->DeduplicateInputs(Context);
+
 	// Load all resources required by the graph
 	for (const auto& [Name, TextureNode] : GraphInstance->GetOutputTextures())
 		TextureNode->Prepare(Context);
@@ -176,64 +494,73 @@ void FTextureSetCompiler::Prepare()
 	for (const auto& [Name, ParameterNode] : GraphInstance->GetOutputParameters())
 		ParameterNode->Prepare(Context);
 
+	const int32 TileCacheSizeMB = CVarTileCacheSizeMB.GetValueOnGameThread();
+	if (TileCacheSizeMB > 0)
+	{
+		TileCache = MakeShared<FTextureTileCache>((int64)TileCacheSizeMB * 1024 * 1024);
+
+		// Outputs which share a node also share a cache operator, so they share cached tiles
+		TMap<const ITextureProcessingNode*, TSharedRef<ITextureProcessingNode>> CacheOperators;
+
+		for (const auto& [Name, TextureNode] : GraphInstance->GetOutputTextures())
+		{
+			if (!CacheOperators.Contains(&TextureNode.Get()))
+				CacheOperators.Add(&TextureNode.Get(), MakeShared<FTextureOperatorTileCache>(TextureNode, TileCache.ToSharedRef()));
+
+			TileCachedOutputTextures.Add(Name, CacheOperators.FindChecked(&TextureNode.Get()));
+		}
+	}
+
 	bPrepared = true;
 }
 
-void FTextureSetCompiler::ConfigureTexture(FDerivedTexture& DerivedTexture, int Index) const
+uint8 FTextureSetCompiler::GetConstantChannels(int Index, FVector4f& OutValues) const
 {
-	FScopeLock Lock(DerivedTexture.TextureCS.Get());
-
-	// Configure texture MUST be called only in the game thread.
-	// Changing texture properties in a thread can cause a crash in the texture compiler.
-	check(IsInGameThread());
-
-	UTexture* Texture = DerivedTexture.Texture;
+	check(bPrepared);
 
-	const FTextureSetPackedTextureDef TextureDef = Args->PackingInfo.GetPackedTextureDef(Index);
 	const FTextureSetPackedTextureInfo TextureInfo = Args->PackingInfo.GetPackedTextureInfo(Index);
+	const TMap<FName, TSharedRef<ITextureProcessingNode>>& OutputTextures = GraphInstance->GetOutputTextures();
 
-	// sRGB if possible
-	Texture->SRGB = TextureInfo.HardwareSRGB;
+	// Channels with no output are filled with black, and alpha with white
+	OutValues = FVector4f(0, 0, 0, 1);
+	uint8 ConstantMask = 0;
 
-	// Make sure the texture's compression settings are correct
-	Texture->CompressionSettings = TextureDef.CompressionSettings;
+	for (int c = 0; c < 4; c++)
+	{
+		const TSharedRef<ITextureProcessingNode>* OutputTexture = c < TextureInfo.ChannelCount ? OutputTextures.Find(TextureInfo.ChannelInfo[c].ProcessedTexture) : nullptr;
 
-	// Let the texture compression know if we don't need the alpha channel
-	Texture->CompressionNoAlpha = TextureInfo.ChannelCount <= 3;
+		if (!OutputTexture)
+		{
+			ConstantMask |= 1 << c;
+			continue;
+		}
 
-	Texture->VirtualTextureStreaming = TextureDef.bVirtualTextureStreaming;
-	// Set the ID of the generated source to match the hash ID of this texture.
-	// This will be used to recover the derived texture data from the DDC if possible.
-	Texture->Source.SetId(GetTextureDataId(Index), true);
+		const int32 ProcessedChannel = TextureInfo.ChannelInfo[c].ProessedTextureChannel;
+		FVector4f OutputValues;
 
-	// Important that this is set properly for streaming
-	Texture->SetDeterministicLightingGuid();
+		if ((*OutputTexture)->GetConstantChannels(OutputValues) & (1 << ProcessedChannel))
+		{
+			OutValues[c] = OutputValues[ProcessedChannel];
+			ConstantMask |= 1 << c;
+		}
+	}
 
-	if (DerivedTexture.TextureState < EDerivedTextureState::Configured)
-		DerivedTexture.TextureState = EDerivedTextureState::Configured;
+	return ConstantMask;
+}
 
+ETextureSourceFormat FTextureSetCompiler::GetTextureSourceFormat(int Index) const
+{
+	return TextureSetEncoding::ChooseSourceFormat(Args->PackingInfo.GetPackedTextureDef(Index), Args->PackingInfo.GetPackedTextureInfo(Index));
 }
 
-void FTextureSetCompiler::InitializeTextureSource(FDerivedTexture& DerivedTexture, int Index) const
+FIntVector3 FTextureSetCompiler::GetTextureSourceSize(int Index) const
 {
 	check(bPrepared);
-	check(IsInGameThread());
-
-	FScopeLock Lock(DerivedTexture.TextureCS.Get());
-
-	FTextureSource& Source = DerivedTexture.Texture->Source;
 
-	check(DerivedTexture.TextureState >= EDerivedTextureState::Configured);
-
-	if (DerivedTexture.TextureState >= EDerivedTextureState::SourceInitialized)
-		return;
-
-	const FTextureSetPackedTextureDef TextureDef = Args->PackingInfo.GetPackedTextureDef(Index);
 	const FTextureSetPackedTextureInfo TextureInfo = Args->PackingInfo.GetPackedTextureInfo(Index);
 	int Width = 4;
 	int Height = 4;
 	int Slices = 1;
-	int Mips = 1;
 	float Ratio = 0.0f;
 
 	const TMap<FName, TSharedRef<ITextureProcessingNode>>& OutputTextures = GraphInstance->GetOutputTextures();
@@ -265,231 +592,743 @@ void FTextureSetCompiler::InitializeTextureSource(FDerivedTexture& DerivedTextur
 		}
 	};
 
-	if (!Source.IsValid() || Source.GetSizeX() != Width || Source.GetSizeY() != Height || Source.GetNumSlices() != Slices || Source.GetNumMips() != Mips || Source.GetFormat() != TSF_RGBA32F)
+	// A texture with no varying channels only needs to be big enough to hold the constant values
+	FVector4f ConstantValues;
+	if (GetConstantChannels(Index, ConstantValues) == 0xF)
 	{
-		FSharedBuffer ZeroLengthBuffer = FUniqueBuffer::Alloc(0).MoveToShared();
-		Source.Init(Width, Height, Slices, Mips, TSF_RGBA32F, ZeroLengthBuffer);
-		
-		// Initializing source resets the ID, so put it back
-		Source.SetId(GetTextureDataId(Index), true);
+		Width = 4;
+		Height = 4;
+		Slices = 1;
 	}
 
-	DerivedTexture.TextureState = EDerivedTextureState::SourceInitialized;
+	return FIntVector3(Width, Height, Slices);
 }
 
-void FTextureSetCompiler::GenerateTextureSource(FDerivedTexture& DerivedTexture, int Index) const
+int64 FTextureSetCompiler::EstimatePeakMemory() const
 {
 	check(bPrepared);
-	FScopeLock Lock(DerivedTexture.TextureCS.Get());
-
-	check(DerivedTexture.TextureState >= EDerivedTextureState::SourceInitialized);
-
-	if (DerivedTexture.TextureState == EDerivedTextureState::SourceGenerated)
-		return; // Early out since we already have the source generated
-
-#if BENCHMARK_TEXTURESET_COMPILATION
-	const double BuildStartTime = FPlatformTime::Seconds();
-	double SectionStartTime = BuildStartTime;
-	FString DebugContext = DerivedTexture.Texture->GetName();
-#endif
-
-	const FTextureSetPackedTextureDef TextureDef = Args->PackingInfo.GetPackedTextureDef(Index);
-	const FTextureSetPackedTextureInfo TextureInfo = Args->PackingInfo.GetPackedTextureInfo(Index);
 
-	const TMap<FName, TSharedRef<ITextureProcessingNode>>& OutputTextures = GraphInstance->GetOutputTextures();
+	// Every distinct source read holds its decoded mip until the last packed texture using it has been generated,
+	// and packed textures are generated concurrently, so all of them can be loaded at once.
+	TSet<const FTextureRead*> TextureReads;
+	int64 SourceBytes = 0;
 
-	for (int c = 0; c < TextureInfo.ChannelCount; c++)
+	for (const auto& [Name, Input] : GraphInstance->GetInputTextures())
 	{
-		const auto& ChanelInfo = TextureInfo.ChannelInfo[c];
+		bool bAlreadyCounted = false;
+		TextureReads.Add(&Input->GetTextureRead().Get(), &bAlreadyCounted);
 
-		if (!OutputTextures.Contains(ChanelInfo.ProcessedTexture))
-			continue;
+		if (!bAlreadyCounted)
+			SourceBytes += Input->GetTextureRead()->GetSourceMipSize();
+	}
 
-		const TSharedRef<ITextureProcessingNode> OutputTexture = OutputTextures.FindChecked(ChanelInfo.ProcessedTexture);
+	int64 GeneratedBytes = 0;
 
-		OutputTexture->Cache();
-	}
+	for (int i = 0; i < Args->PackingInfo.NumPackedTextures(); i++)
+		GeneratedBytes += TextureSetCompilerImpl::EstimateGeneratedMemory(Args->PackingInfo, i, GetTextureSourceSize(i));
 
-	FVector4f RestoreMul = FVector4f::One();
-	FVector4f RestoreAdd = FVector4f::Zero();
+	return SourceBytes + GeneratedBytes + TextureSetCompilerImpl::EstimateIntermediateMemory();
+}
 
-#if BENCHMARK_TEXTURESET_COMPILATION
-	UE_LOG(LogTextureSet, Log, TEXT("%s Build: Initializing processing graph took %fs"), *DebugContext, FPlatformTime::Seconds() - SectionStartTime);
-	SectionStartTime = FPlatformTime::Seconds();
-#endif
- 
-	// TODO: Support textures sources of lower precision
-	FTextureSource& Source = DerivedTexture.Texture->Source;
-	const int Width = Source.GetSizeX();
-	const int Height = Source.GetSizeY();
-	const int Slices = Source.GetNumSlices();
-	const FIntVector3 TextureSize(Width, Height, Slices);
-	check(Source.GetFormat() == ETextureSourceFormat::TSF_RGBA32F);
-	const uint8 PixelValueStride = 4;
+int64 FTextureSetCompiler::EstimatePeakMemory(const FTextureSetCompilerArgs& Args)
+{
+	// Mirrors FTextureRead::GetSourceMipSize, using only the source metadata
+	TSet<const UTexture*> Textures;
+	FIntVector3 MaxReadSize(4, 4, 1);
+	int64 SourceBytes = 0;
 
-	// Init with NewData == null is used to allocate space, which is then filled with LockMip
-	Source.Init(Width, Height, Slices, 1, TSF_RGBA32F, nullptr);
-	float* PixelValues = (float*)Source.LockMip(0);
-	check(PixelValues != nullptr);
+	for (const auto& [Name, TextureRef] : Args.SourceTextures)
+	{
+		const UTexture* Texture = TextureRef.GetTexture();
 
-	#if BENCHMARK_TEXTURESET_COMPILATION
-	UE_LOG(LogTextureSet, Log, TEXT("%s Build: Allocating source buffer took %fs"), *DebugContext, FPlatformTime::Seconds() - SectionStartTime);
-	SectionStartTime = FPlatformTime::Seconds();
-	#endif
+		bool bAlreadyCounted = false;
+		if (!IsValid(Texture) || !Texture->Source.IsValid())
+			continue;
 
-	const FIntVector3 NumTiles = FIntVector3::DivideAndRoundUp(TextureSize, Args->TileSize);
-	const int32 TotalTiles = NumTiles.X * NumTiles.Y * NumTiles.Z;
+		Textures.Add(Texture, &bAlreadyCounted);
+		if (bAlreadyCounted)
+			continue;
 
-	for (uint8 c = 0; c < 4; c++) // Process each channel
-	{
-		const auto& ChanelInfo = TextureInfo.ChannelInfo[c];
+		const FTextureSource& Source = Texture->Source;
+		FIntVector3 ReadSize(Source.GetSizeX(), Source.GetSizeY(), Source.GetNumSlices());
+		int32 ReadMip = 0;
+		bool bConvert = false;
 
-		if (c < TextureInfo.ChannelCount && OutputTextures.Contains(ChanelInfo.ProcessedTexture))
+		if (Args.PreviewMaxSize > 0)
 		{
-			TSharedRef<ITextureProcessingNode> ProcessedTexture = OutputTextures.FindChecked(ChanelInfo.ProcessedTexture);
-			ITextureProcessingNode::FTextureDimension ProcessedTextureDimension = ProcessedTexture->GetTextureDimension();
-
-			check(ProcessedTextureDimension.Width <= Width);
-			check(ProcessedTextureDimension.Height <= Height);
+			int32 Levels = 0;
+			while (FMath::Max(ReadSize.X, ReadSize.Y) >> Levels > Args.PreviewMaxSize)
+				Levels++;
 
-			if (ProcessedTextureDimension.Width < Width || ProcessedTextureDimension.Height < Height)
+			if (Levels < Source.GetNumMips())
 			{
-				ProcessedTexture = MakeShared<FTextureOperatorEnlarge>(ProcessedTexture, Width, Height, Slices);
+				ReadMip = Levels;
+				ReadSize.X = FMath::Max(1, ReadSize.X >> Levels);
+				ReadSize.Y = FMath::Max(1, ReadSize.Y >> Levels);
 			}
-
-			// Compute the tile for each channel
-			for (int32 t = 0; t < TotalTiles; t++)
+			else
 			{
-				const FIntVector3 TileOffset(
-					Args->TileSize.X * (t % NumTiles.X),
-					Args->TileSize.Y * ((t / NumTiles.X) % NumTiles.Y),
-					Args->TileSize.Z * (t / (NumTiles.X * NumTiles.Y))
-				);
-				check(TileOffset.Z < TextureSize.Z);
-
-				const FIntVector3 TileSize = Args->TileSize.ComponentMin(TextureSize - TileOffset);
-				check(TileSize.GetMin() > 0);
-
-				const FIntVector3 DataStride = FTextureDataTileDesc::ComputeDataStrides(PixelValueStride, TextureSize);
-				const int32 DataOffset = c + FTextureDataTileDesc::ComputeDataOffset(TileOffset, DataStride);
-
-				FTextureDataTileDesc TileDesc(
-					TextureSize,
-					TileSize,
-					TileOffset,
-					DataStride,
-					DataOffset
-				);
-
-				ProcessedTexture->WriteChannel(ChanelInfo.ProessedTextureChannel, TileDesc, PixelValues);
+				ReadSize.X = FMath::DivideAndRoundUp(ReadSize.X, 1 << Levels);
+				ReadSize.Y = FMath::DivideAndRoundUp(ReadSize.Y, 1 << Levels);
+				bConvert = true;
 			}
+		}
 
-			#if BENCHMARK_TEXTURESET_COMPILATION
-			UE_LOG(LogTextureSet, Log, TEXT("%s Build: Processing graph exectution for channel %i took %fs"), *DebugContext, c, FPlatformTime::Seconds() - SectionStartTime);
-			SectionStartTime = FPlatformTime::Seconds();
-			#endif
-
-			// For encoding we don't allocate any data, so use a single tile that covers the whole image.
-			FTextureDataTileDesc TileDesc(
-				TextureSize,
-				TextureSize,
-				FIntVector3::ZeroValue,
-				FTextureDataTileDesc::ComputeDataStrides(PixelValueStride, TextureSize),
-				c
-			);
-
-			// Channel encoding (decoding happens in FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode)
-			if (ChanelInfo.ChannelEncoding & (uint8)ETextureSetChannelEncoding::RangeCompression)
-			{
-				// Initialize the max and min pixel values so they will be overridden by the first pixel
-				float Min = TNumericLimits<float>::Max();
-				float Max = TNumericLimits<float>::Lowest();
+		SourceBytes += Source.CalcMipSize(ReadMip);
 
-				// Calculate the min and max values
-				TileDesc.ForEachPixel([PixelValues, &Min, &Max](FTextureDataTileDesc::ForEachPixelContext& Context)
-				{
-					const float PixelValue = PixelValues[Context.DataIndex];
-					Min = FMath::Min(Min, PixelValue);
-					Max = FMath::Max(Max, PixelValue);
-				});
+		// Downsampled reads are converted to float (or half, for half sources), with the same number of channels as the source
+		if (bConvert)
+		{
+			const ETextureSourceFormat Format = Source.GetFormat();
+			const bool bHalfSource = Format == TSF_R16F || Format == TSF_RGBA16F;
+			const bool bSingleChannel = Format == TSF_G8 || Format == TSF_G16 || Format == TSF_R16F || Format == TSF_R32F;
+			const ETextureSourceFormat ConvertedFormat = bSingleChannel ? (bHalfSource ? TSF_R16F : TSF_R32F) : (bHalfSource ? TSF_RGBA16F : TSF_RGBA32F);
+			SourceBytes += (int64)ReadSize.X * ReadSize.Y * ReadSize.Z * FTextureSource::GetBytesPerPixel(ConvertedFormat);
+		}
 
-				if (Min >= Max)
-				{
-					// Essentially ignore the texture at runtime and use the min value
-					RestoreMul[c] = 0;
-					RestoreAdd[c] = Min;
-				}
-				else
-				{
-					// Adjust the texture and set the constant values for decompression
-					float CompressMul = 1.0f / (Max - Min);
-					float CompressAdd = -Min * CompressMul;
-
-					TileDesc.ForEachPixel([PixelValues, CompressMul, CompressAdd](FTextureDataTileDesc::ForEachPixelContext& Context)
-					{
-						PixelValues[Context.DataIndex] = PixelValues[Context.DataIndex] * CompressMul + CompressAdd;
-					});
-
-					RestoreMul[c] = Max - Min;
-					RestoreAdd[c] = Min;
-
-					#if BENCHMARK_TEXTURESET_COMPILATION
-					UE_LOG(LogTextureSet, Log, TEXT("%s Build: Range compression of channel %i took %fs"), *DebugContext, c, FPlatformTime::Seconds() - SectionStartTime);
-					SectionStartTime = FPlatformTime::Seconds();
-					#endif
-				}
-			}
+		MaxReadSize = MaxReadSize.ComponentMax(ReadSize);
+	}
 
-			if ((ChanelInfo.ChannelEncoding & (uint8)ETextureSetChannelEncoding::SRGB) && (!TextureInfo.HardwareSRGB || c >= 3))
-			{
-				TileDesc.ForEachPixel([PixelValues](FTextureDataTileDesc::ForEachPixelContext& Context)
-				{
-					PixelValues[Context.DataIndex] = FMath::Pow(PixelValues[Context.DataIndex], 1.0f / 2.2f);
-				});
+	int64 GeneratedBytes = 0;
 
-				#if BENCHMARK_TEXTURESET_COMPILATION
-				UE_LOG(LogTextureSet, Log, TEXT("%s Build: SRGB adjustment of channel %i took %fs"), *DebugContext, c, FPlatformTime::Seconds() - SectionStartTime);
-				SectionStartTime = FPlatformTime::Seconds();
-				#endif
-			}
+	for (int i = 0; i < Args.PackingInfo.NumPackedTextures(); i++)
+		GeneratedBytes += TextureSetCompilerImpl::EstimateGeneratedMemory(Args.PackingInfo, i, MaxReadSize);
 
-		}
-		else
-		{
-			FTextureDataTileDesc TileDesc(
-				TextureSize,
-				TextureSize,
-				FIntVector3::ZeroValue,
-				FTextureDataTileDesc::ComputeDataStrides(PixelValueStride, TextureSize),
-				c
-			);
-
-			if (c < 3)
-			{
-				TileDesc.ForEachPixel([PixelValues](FTextureDataTileDesc::ForEachPixelContext& Context)
-				{
-					PixelValues[Context.DataIndex] = 0.0f; // Fill RGB with black
-				});
-			}
-			else
-			{
-				TileDesc.ForEachPixel([PixelValues](FTextureDataTileDesc::ForEachPixelContext& Context)
-				{
-					PixelValues[Context.DataIndex] = 1.0f; // Fill Alpha with white
-				});
-			}
+	return SourceBytes + GeneratedBytes + TextureSetCompilerImpl::EstimateIntermediateMemory();
+}
 
-			#if BENCHMARK_TEXTURESET_COMPILATION
-				UE_LOG(LogTextureSet, Log, TEXT("%s Build: Filling channel %i with blank data took %fs"), *DebugContext, c, FPlatformTime::Seconds() - SectionStartTime);
-				SectionStartTime = FPlatformTime::Seconds();
-			#endif
-		}
-	};
+void FTextureSetCompiler::ConfigureTexture(FDerivedTexture& DerivedTexture, int Index) const
+{
+	FScopeLock Lock(DerivedTexture.TextureCS.Get());
 
-	Source.UnlockMip(0);
+	// Configure texture MUST be called only in the game thread.
+	// Changing texture properties in a thread can cause a crash in the texture compiler.
+	check(IsInGameThread());
 
-	// UnlockMip causes GUID to be set from a hash, so force it back to the one we want to use
-	Source.SetId(GetTextureDataId(Index), true);
+	UTexture* Texture = DerivedTexture.Texture;
+
+	const FTextureSetPackedTextureDef TextureDef = Args->PackingInfo.GetPackedTextureDef(Index);
+	const FTextureSetPackedTextureInfo TextureInfo = Args->PackingInfo.GetPackedTextureInfo(Index);
+
+	// sRGB if possible
+	Texture->SRGB = TextureInfo.HardwareSRGB;
+
+	// Make sure the texture's compression settings are correct
+	Texture->CompressionSettings = TextureDef.CompressionSettings;
+
+	// Let the texture compression know if we don't need the alpha channel
+	Texture->CompressionNoAlpha = TextureInfo.ChannelCount <= 3;
+
+	Texture->VirtualTextureStreaming = TextureDef.bVirtualTextureStreaming;
+	// Set the ID of the generated source to match the hash ID of this texture.
+	// This will be used to recover the derived texture data from the DDC if possible.
+	Texture->Source.SetId(GetTextureDataId(Index), true);
+
+	// Important that this is set properly for streaming
+	Texture->SetDeterministicLightingGuid();
+
+	if (DerivedTexture.TextureState < EDerivedTextureState::Configured)
+		DerivedTexture.TextureState = EDerivedTextureState::Configured;
+
+}
+
+void FTextureSetCompiler::InitializeTextureSource(FDerivedTexture& DerivedTexture, int Index) const
+{
+	check(bPrepared);
+	check(IsInGameThread());
+
+	FScopeLock Lock(DerivedTexture.TextureCS.Get());
+
+	FTextureSource& Source = DerivedTexture.Texture->Source;
+
+	check(DerivedTexture.TextureState >= EDerivedTextureState::Configured);
+
+	if (DerivedTexture.TextureState >= EDerivedTextureState::SourceInitialized)
+		return;
+
+	const FIntVector3 Size = GetTextureSourceSize(Index);
+	const int Width = Size.X;
+	const int Height = Size.Y;
+	const int Slices = Size.Z;
+	const int Mips = 1;
+
+	const ETextureSourceFormat Format = GetTextureSourceFormat(Index);
+
+	if (!Source.IsValid() || Source.GetSizeX() != Width || Source.GetSizeY() != Height || Source.GetNumSlices() != Slices || Source.GetNumMips() != Mips || Source.GetFormat() != Format)
+	{
+		FSharedBuffer ZeroLengthBuffer = FUniqueBuffer::Alloc(0).MoveToShared();
+		Source.Init(Width, Height, Slices, Mips, Format, ZeroLengthBuffer);
+		
+		// Initializing source resets the ID, so put it back
+		Source.SetId(GetTextureDataId(Index), true);
+	}
+
+	DerivedTexture.TextureState = EDerivedTextureState::SourceInitialized;
+}
+
+void FTextureSetCompiler::GenerateTextureSource(FDerivedTexture& DerivedTexture, int Index, FTextureSetGenerationCacheData* CacheData) const
+{
+	check(bPrepared);
+	FScopeLock Lock(DerivedTexture.TextureCS.Get());
+
+	check(DerivedTexture.TextureState >= EDerivedTextureState::SourceInitialized);
+
+	if (DerivedTexture.TextureState == EDerivedTextureState::SourceGenerated)
+		return; // Early out since we already have the source generated
+
+	if (IsCancelled())
+		return;
+
+	const bool bUseSourceCache = CVarSourceCache.GetValueOnAnyThread() && !IsPreview();
+
+	// Generation outside of a compile task (e.g. from a texture source provider) does its own lookups
+	FTextureSetGenerationCacheData LocalCacheData;
+
+	if (UsesGenerationCaches())
+	{
+		if (!CacheData)
+			CacheData = &LocalCacheData;
+
+		if (!CacheData->bFetched)
+			FetchGenerationCacheData(MakeArrayView(&Index, 1), MakeArrayView(CacheData, 1));
+
+		const FSharedBuffer SourceRecord = MoveTemp(CacheData->Source);
+		if (bUseSourceCache && !SourceRecord.IsNull() && RestoreTextureSource(DerivedTexture, Index, SourceRecord))
+		{
+			DerivedTexture.TextureState = EDerivedTextureState::SourceGenerated;
+			return;
+		}
+	}
+
+	const double GenerateStartTime = FPlatformTime::Seconds();
+
+#if BENCHMARK_TEXTURESET_COMPILATION
+	const double BuildStartTime = FPlatformTime::Seconds();
+	double SectionStartTime = BuildStartTime;
+	FString DebugContext = DerivedTexture.Texture->GetName();
+#endif
+
+	const FTextureSetPackedTextureDef TextureDef = Args->PackingInfo.GetPackedTextureDef(Index);
+	const FTextureSetPackedTextureInfo TextureInfo = Args->PackingInfo.GetPackedTextureInfo(Index);
+
+	// Use the tile cached outputs if enabled, they generate identical data
+	const TMap<FName, TSharedRef<ITextureProcessingNode>>& OutputTextures = TileCache.IsValid() ? TileCachedOutputTextures : GraphInstance->GetOutputTextures();
+
+	FVector4f RestoreMul = FVector4f::One();
+	FVector4f RestoreAdd = FVector4f::Zero();
+
+	FTextureSource& Source = DerivedTexture.Texture->Source;
+	const int Width = Source.GetSizeX();
+	const int Height = Source.GetSizeY();
+	const int Slices = Source.GetNumSlices();
+	const FIntVector3 TextureSize(Width, Height, Slices);
+	const ETextureSourceFormat Format = GetTextureSourceFormat(Index);
+	check(Source.GetFormat() == Format);
+
+	// Texture data is generated as float into a small per-tile scratch buffer, and then encoded and converted directly
+	// into the texture source format, so we never need to hold a full resolution float copy of the texture.
+	const int32 FormatChannels = TextureSetEncoding::GetSourceFormatChannels(Format);
+	const FInt64Vector3 DestDataStride = FTextureDataTileDesc::ComputeDataStrides(FormatChannels, TextureSize);
+	const int32 ElementSize = FTextureSource::GetBytesPerPixel(Format) / FormatChannels;
+	const int64 NumPixels = (int64)Width * Height * Slices;
+
+	// 8 bit formats of an sRGB texture are interpreted as sRGB encoded, so hardware sRGB channels need to be stored encoded
+	const uint8 SRGBStoreMask = (TextureInfo.HardwareSRGB && TextureSetEncoding::SourceFormatStoresSRGB(Format)) ? 0x7 : 0;
+
+	// Constant channels don't need to be generated per pixel
+	FVector4f ConstantValues;
+	const uint8 ConstantChannelMask = GetConstantChannels(Index, ConstantValues);
+	// Decoded values, for when the material reads the constants instead of sampling the texture
+	const FVector4f DecodedConstantValues = ConstantValues;
+
+	// Look up the generated channels in the channel cache, so only channels whose inputs changed are generated
+	const uint8 ChannelCacheMask = GetChannelCacheMask(Index); // Channels which should be stored in the channel cache once generated
+	TStaticArray<FSharedBuffer, 4> CachedChannelData;
+	uint8 ChannelCacheHitMask = 0; // Channels which were found in the channel cache
+
+	if (ChannelCacheMask)
+	{
+		check(CacheData && CacheData->bFetched);
+
+		for (int c = 0; c < 4; c++)
+		{
+			FSharedBuffer ChannelData = MoveTemp(CacheData->Channels[c]);
+
+			// Treat anything unexpected as a miss, and overwrite it once generated
+			if (!(ChannelCacheMask & (1 << c)) || ChannelData.GetSize() != sizeof(TextureSetCompilerImpl::FChannelCacheHeader) + NumPixels * ElementSize)
+				continue;
+
+			CachedChannelData[c] = MoveTemp(ChannelData);
+			ChannelCacheHitMask |= 1 << c;
+		}
+	}
+
+	// Outputs which have been cached, and need to be released once generation is done
+	TArray<TSharedRef<ITextureProcessingNode>, TInlineAllocator<4>> CachedTextures;
+
+	for (int c = 0; c < TextureInfo.ChannelCount; c++)
+	{
+		const auto& ChanelInfo = TextureInfo.ChannelInfo[c];
+
+		// Channels from the channel cache don't need their sources loaded
+		if (!OutputTextures.Contains(ChanelInfo.ProcessedTexture) || (ChannelCacheHitMask & (1 << c)))
+			continue;
+
+		const TSharedRef<ITextureProcessingNode> OutputTexture = OutputTextures.FindChecked(ChanelInfo.ProcessedTexture);
+
+		OutputTexture->Cache();
+		CachedTextures.Add(OutputTexture);
+	}
+
+#if BENCHMARK_TEXTURESET_COMPILATION
+	UE_LOG(LogTextureSet, Log, TEXT("%s Build: Initializing processing graph took %fs (%i channels from the channel cache)"), *DebugContext, FPlatformTime::Seconds() - SectionStartTime, FMath::CountBits(ChannelCacheHitMask));
+	SectionStartTime = FPlatformTime::Seconds();
+#endif
+
+	// Init with NewData == null is used to allocate space, which is then filled with LockMip
+	Source.Init(Width, Height, Slices, 1, Format, nullptr);
+	uint8* SourceData = Source.LockMip(0);
+	check(SourceData != nullptr);
+
+	#if BENCHMARK_TEXTURESET_COMPILATION
+	UE_LOG(LogTextureSet, Log, TEXT("%s Build: Allocating source buffer took %fs"), *DebugContext, FPlatformTime::Seconds() - SectionStartTime);
+	SectionStartTime = FPlatformTime::Seconds();
+	#endif
+
+	for (int c = 0; c < 4; c++)
+	{
+		if (!(ChannelCacheHitMask & (1 << c)))
+			continue;
+
+		const uint8* ChannelData = (const uint8*)CachedChannelData[c].GetData();
+		const TextureSetCompilerImpl::FChannelCacheHeader* Header = (const TextureSetCompilerImpl::FChannelCacheHeader*)ChannelData;
+		RestoreMul[c] = Header->RestoreMul;
+		RestoreAdd[c] = Header->RestoreAdd;
+
+		TextureSetCompilerImpl::CopyInterleavedElements(
+			ChannelData + sizeof(TextureSetCompilerImpl::FChannelCacheHeader), 1,
+			SourceData + TextureSetEncoding::GetSourceFormatChannelIndex(Format, c) * ElementSize, FormatChannels,
+			ElementSize, NumPixels);
+
+		CachedChannelData[c].Reset();
+	}
+
+	// Channels which come from the same processed texture, and have the same offset between the processed channel and
+	// the packed channel, are generated together with a single WriteChannels() call so nodes can share work between them.
+	struct FChannelGroup
+	{
+		TSharedPtr<ITextureProcessingNode> ProcessedTexture; // Null if the channels should be filled with constant values
+		int32 ChannelOffset; // Offset from processed texture channel to packed texture channel
+		uint8 ChannelMask; // Mask of processed texture channels to write
+		uint8 RangeCompressMask; // Mask of processed texture channels which are range compressed
+	};
+
+	TArray<FChannelGroup, TInlineAllocator<4>> ChannelGroups;
+	// Keyed by output node rather than name, so deduplicated outputs are generated together
+	TMap<const ITextureProcessingNode*, TSharedRef<ITextureProcessingNode>> ProcessedTextures;
+	uint8 OutputChannelMask = 0;
+
+	for (uint8 c = 0; c < TextureInfo.ChannelCount; c++)
+	{
+		const auto& ChanelInfo = TextureInfo.ChannelInfo[c];
+
+		if (!OutputTextures.Contains(ChanelInfo.ProcessedTexture))
+			continue;
+
+		OutputChannelMask |= 1 << c;
+
+		if ((ConstantChannelMask | ChannelCacheHitMask) & (1 << c))
+			continue;
+
+		const ITextureProcessingNode* OutputTexture = &OutputTextures.FindChecked(ChanelInfo.ProcessedTexture).Get();
+
+		if (!ProcessedTextures.Contains(OutputTexture))
+		{
+			TSharedRef<ITextureProcessingNode> ProcessedTexture = OutputTextures.FindChecked(ChanelInfo.ProcessedTexture);
+			ITextureProcessingNode::FTextureDimension ProcessedTextureDimension = ProcessedTexture->GetTextureDimension();
+
+			check(ProcessedTextureDimension.Width <= Width);
+			check(ProcessedTextureDimension.Height <= Height);
+
+			if (ProcessedTextureDimension.Width < Width || ProcessedTextureDimension.Height < Height)
+			{
+				ProcessedTexture = MakeShared<FTextureOperatorEnlarge>(ProcessedTexture, Width, Height, Slices);
+			}
+
+			ProcessedTextures.Add(OutputTexture, ProcessedTexture);
+		}
+
+		const TSharedRef<ITextureProcessingNode>& ProcessedTexture = ProcessedTextures.FindChecked(OutputTexture);
+		const int32 ChannelOffset = c - ChanelInfo.ProessedTextureChannel;
+
+		FChannelGroup* Group = ChannelGroups.FindByPredicate([&](const FChannelGroup& G) { return G.ProcessedTexture.Get() == &ProcessedTexture.Get() && G.ChannelOffset == ChannelOffset; });
+
+		if (!Group)
+			Group = &ChannelGroups.Add_GetRef({ProcessedTexture, ChannelOffset, 0, 0});
+
+		Group->ChannelMask |= 1 << ChanelInfo.ProessedTextureChannel;
+
+		if (ChanelInfo.ChannelEncoding & (uint8)ETextureSetChannelEncoding::RangeCompression)
+			Group->RangeCompressMask |= 1 << ChanelInfo.ProessedTextureChannel;
+	}
+
+	// Constant channels get filled with their value as part of the same tile pipeline
+	if (ConstantChannelMask)
+		ChannelGroups.Add({nullptr, 0, ConstantChannelMask, 0});
+
+	FIntVector3 TileSize = Args->TileSize;
+
+	if (TileSize.GetMin() <= 0)
+	{
+		FIntVector3 TileSizeHint = FIntVector3::ZeroValue;
+		for (const FChannelGroup& Group : ChannelGroups)
+		{
+			if (Group.ProcessedTexture.IsValid())
+				TileSizeHint = ITextureProcessingNode::CombineTileSizeHints(TileSizeHint, Group.ProcessedTexture->GetPreferredTileSize());
+		}
+
+		// Working set of a tile is the float scratch data, and the converted data written to the texture source
+		const int64 BytesPerPixel = 4 * sizeof(float) + FTextureSource::GetBytesPerPixel(Format);
+		const int64 CacheBudget = TextureSetCompilerImpl::GetTileCacheBudget();
+		TileSize = TextureSetCompilerImpl::ChooseTileSize(TileSizeHint, TextureSize, BytesPerPixel, CacheBudget);
+
+		UE_LOG(LogTextureSet, Verbose, TEXT("%s: Using tile size %ix%ix%i for %ix%ix%i texture (node hint %ix%ix%i, cache budget %lldKB)"), *DerivedTexture.Texture->GetName(),
+			TileSize.X, TileSize.Y, TileSize.Z, TextureSize.X, TextureSize.Y, TextureSize.Z, TileSizeHint.X, TileSizeHint.Y, TileSizeHint.Z, CacheBudget / 1024);
+	}
+
+	const FIntVector3 NumTiles = FIntVector3::DivideAndRoundUp(TextureSize, TileSize);
+	const int32 TotalTiles = NumTiles.X * NumTiles.Y * NumTiles.Z;
+
+	// Tiles are ordered by row, so a band is a run of whole tile rows
+	const int32 BandHeight = CVarGenerationBandHeight.GetValueOnAnyThread();
+	const int32 TilesPerBand = BandHeight > 0 ? NumTiles.X * FMath::DivideAndRoundUp(BandHeight, TileSize.Y) : TotalTiles;
+
+	// Channel encoding (decoding happens in FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode)
+	// Constant channels are encoded here once, the rest are encoded per tile.
+	uint8 RangeCompressMask = 0;
+	uint8 GammaEncodeMask = 0;
+
+	for (uint8 c = 0; c < TextureInfo.ChannelCount; c++)
+	{
+		if (!(OutputChannelMask & (1 << c)))
+			continue;
+
+		const auto& ChanelInfo = TextureInfo.ChannelInfo[c];
+		const bool bRangeCompress = ChanelInfo.ChannelEncoding & (uint8)ETextureSetChannelEncoding::RangeCompression;
+		const bool bGammaEncode = (ChanelInfo.ChannelEncoding & (uint8)ETextureSetChannelEncoding::SRGB) && (!TextureInfo.HardwareSRGB || c >= 3);
+
+		if (ConstantChannelMask & (1 << c))
+		{
+			if (bRangeCompress)
+			{
+				// Essentially ignore the texture at runtime and use the constant value
+				RestoreMul[c] = 0;
+				RestoreAdd[c] = ConstantValues[c];
+				ConstantValues[c] = 0;
+			}
+			else if (bGammaEncode)
+			{
+				ConstantValues[c] = TextureSetEncoding::GammaEncode(ConstantValues[c]);
+			}
+			continue;
+		}
+
+		// Already encoded, and restore values set from the channel cache
+		if (ChannelCacheHitMask & (1 << c))
+			continue;
+
+		if (bRangeCompress)
+			RangeCompressMask |= 1 << c;
+
+		if (bGammaEncode)
+			GammaEncodeMask |= 1 << c;
+	}
+
+	auto GetTileOffset = [&](int32 t)
+	{
+		const FIntVector3 TileOffset(
+			TileSize.X * (t % NumTiles.X),
+			TileSize.Y * ((t / NumTiles.X) % NumTiles.Y),
+			TileSize.Z * (t / (NumTiles.X * NumTiles.Y))
+		);
+		check(TileOffset.Z < TextureSize.Z);
+		return TileOffset;
+	};
+
+	// Tile of float RGBA scratch data, where the tile's data index points at ChannelOffset within the first pixel
+	auto MakeScratchTileDesc = [&](const FIntVector3& TileOffset, int32 ChannelOffset)
+	{
+		const FIntVector3 ClampedTileSize = TileSize.ComponentMin(TextureSize - TileOffset);
+		check(ClampedTileSize.GetMin() > 0);
+
+		return FTextureDataTileDesc(
+			TextureSize,
+			ClampedTileSize,
+			TileOffset,
+			FTextureDataTileDesc::ComputeDataStrides(4, ClampedTileSize),
+			ChannelOffset
+		);
+	};
+
+	// Tile of a single channel in the texture source data, indexed by elements of the source format
+	auto MakeDestTileDesc = [&](const FIntVector3& TileOffset, int32 Channel)
+	{
+		return FTextureDataTileDesc(
+			TextureSize,
+			TileSize.ComponentMin(TextureSize - TileOffset),
+			TileOffset,
+			DestDataStride,
+			TextureSetEncoding::GetSourceFormatChannelIndex(Format, Channel) + FTextureDataTileDesc::ComputeDataOffset(TileOffset, DestDataStride)
+		);
+	};
+
+	// Float scratch data of a tile, allocated once per worker the first time it's needed and reused for every tile after that
+	const int64 ScratchSize = (int64)TileSize.X * TileSize.Y * TileSize.Z * 4;
+	TArray<TArray64<float>> WorkerScratch;
+	const int32 NumWorkers = TextureSetCompilerImpl::GetNumTileWorkers();
+	WorkerScratch.SetNum(NumWorkers);
+
+	auto GetScratch = [&WorkerScratch, ScratchSize](int32 Worker)
+	{
+		TArray64<float>& Scratch = WorkerScratch[Worker];
+		if (Scratch.IsEmpty())
+			Scratch.SetNumUninitialized(ScratchSize);
+		return Scratch.GetData();
+	};
+
+	// Min and max value of each range compressed channel, for each tile. Indexed by [Channel * TotalTiles + Tile]
+	TArray<FVector2f> TileRanges;
+	if (RangeCompressMask)
+		TileRanges.SetNumUninitialized(4 * TotalTiles);
+
+	// Range compressed channels can only be encoded once the range of the whole image is known, so their float values are
+	// kept in a full resolution plane per channel until then, rather than evaluating the graph a second time for them.
+	TStaticArray<int64, 4> RangePlaneOffsets;
+	int32 NumRangePlanes = 0;
+
+	for (int32 c = 0; c < FormatChannels; c++)
+	{
+		if (RangeCompressMask & (1 << c))
+			RangePlaneOffsets[c] = NumRangePlanes++ * NumPixels;
+	}
+
+	TArray64<float> RangePlanes;
+	RangePlanes.SetNumUninitialized(NumRangePlanes * NumPixels);
+	const FInt64Vector3 PlaneDataStride = FTextureDataTileDesc::ComputeDataStrides(1, TextureSize);
+
+	// Tile of a range compressed channel in its plane
+	auto MakePlaneTileDesc = [&](const FIntVector3& TileOffset, int32 Channel)
+	{
+		return FTextureDataTileDesc(
+			TextureSize,
+			TileSize.ComponentMin(TextureSize - TileOffset),
+			TileOffset,
+			PlaneDataStride,
+			RangePlaneOffsets[Channel] + FTextureDataTileDesc::ComputeDataOffset(TileOffset, PlaneDataStride)
+		);
+	};
+
+	// Compute every (channel group, tile) pair in parallel, one band at a time. Each one writes to a disjoint region
+	// of the texture data, so the result is deterministic regardless of how the work is scheduled.
+	// Encoding that doesn't depend on the whole image is done while the tile is still in cache, and the range of
+	// range compressed channels is reduced per-tile, to be merged once all tiles are done.
+	TextureSetCompilerImpl::ParallelForTileBands(TotalTiles, TilesPerBand, ChannelGroups.Num(), NumWorkers, [&](int32 t, int32 GroupIndex, int32 Worker)
+	{
+		// Remaining tiles are skipped once cancelled, which only costs the tiles already in flight
+		if (IsCancelled())
+			return;
+
+		const FChannelGroup& Group = ChannelGroups[GroupIndex];
+		const FIntVector3 TileOffset = GetTileOffset(t);
+
+		if (!Group.ProcessedTexture.IsValid())
+		{
+			for (int32 c = 0; c < FormatChannels; c++)
+			{
+				if (Group.ChannelMask & (1 << c))
+					TextureSetEncoding::FillChannel(MakeDestTileDesc(TileOffset, c), SourceData, Format, ConstantValues[c], (SRGBStoreMask & (1 << c)) != 0);
+			}
+			return;
+		}
+
+		float* ScratchData = GetScratch(Worker);
+
+		const FTextureDataTileDesc ScratchTileDesc = MakeScratchTileDesc(TileOffset, Group.ChannelOffset);
+		Group.ProcessedTexture->WriteChannels(Group.ChannelMask, ScratchTileDesc, ScratchData);
+
+		for (int32 p = 0; p < 4; p++)
+		{
+			if (!(Group.ChannelMask & (1 << p)))
+				continue;
+
+			const int32 c = p + Group.ChannelOffset;
+			const FTextureDataTileDesc ChannelTileDesc = ScratchTileDesc.OffsetData(p);
+
+			if (RangeCompressMask & (1 << c))
+			{
+				// Initialize the max and min pixel values so they will be overridden by the first pixel
+				float Min = TNumericLimits<float>::Max();
+				float Max = TNumericLimits<float>::Lowest();
+
+				// Calculate the min and max values
+				ChannelTileDesc.ForEachPixel([ScratchData, &Min, &Max](FTextureDataTileDesc::ForEachPixelContext& Context)
+				{
+					const float PixelValue = ScratchData[Context.DataIndex];
+					Min = FMath::Min(Min, PixelValue);
+					Max = FMath::Max(Max, PixelValue);
+				});
+
+				TileRanges[c * TotalTiles + t] = FVector2f(Min, Max);
+
+				// Range compressed channels are encoded and stored once the range of the whole image is known
+				if (c < FormatChannels)
+					TextureSetEncoding::StoreChannel(ChannelTileDesc, ScratchData, MakePlaneTileDesc(TileOffset, c), (uint8*)RangePlanes.GetData(), TSF_R32F, false);
+
+				continue;
+			}
+
+			if (GammaEncodeMask & (1 << c))
+				TextureSetEncoding::GammaEncodeChannel(ChannelTileDesc, ScratchData, bFastGammaEncode);
+
+			if (c < FormatChannels)
+				TextureSetEncoding::StoreChannel(ChannelTileDesc, ScratchData, MakeDestTileDesc(TileOffset, c), SourceData, Format, (SRGBStoreMask & (1 << c)) != 0);
+		}
+	});
+
+	#if BENCHMARK_TEXTURESET_COMPILATION
+	UE_LOG(LogTextureSet, Log, TEXT("%s Build: Processing graph exectution of %i channel groups (%i tiles each) took %fs"), *DebugContext, ChannelGroups.Num(), TotalTiles, FPlatformTime::Seconds() - SectionStartTime);
+	SectionStartTime = FPlatformTime::Seconds();
+	#endif
+
+	// Ranges of tiles skipped by a cancel were never written, so don't merge them
+	if (RangeCompressMask && !IsCancelled())
+	{
+		// Encoding of range compressed channels, which needs the range of the whole image
+		FVector4f CompressMul = FVector4f::One();
+		FVector4f CompressAdd = FVector4f::Zero();
+		uint8 RemapMask = 0;
+
+		for (int32 c = 0; c < 4; c++)
+		{
+			if (!(RangeCompressMask & (1 << c)))
+				continue;
+
+			// Merge the ranges of all tiles
+			float Min = TNumericLimits<float>::Max();
+			float Max = TNumericLimits<float>::Lowest();
+
+			for (int32 t = 0; t < TotalTiles; t++)
+			{
+				Min = FMath::Min(Min, TileRanges[c * TotalTiles + t].X);
+				Max = FMath::Max(Max, TileRanges[c * TotalTiles + t].Y);
+			}
+
+			if (Min >= Max)
+			{
+				// Essentially ignore the texture at runtime and use the min value
+				RestoreMul[c] = 0;
+				RestoreAdd[c] = Min;
+			}
+			else
+			{
+				// Adjust the texture and set the constant values for decompression
+				CompressMul[c] = 1.0f / (Max - Min);
+				CompressAdd[c] = -Min * CompressMul[c];
+				RemapMask |= 1 << c;
+
+				RestoreMul[c] = Max - Min;
+				RestoreAdd[c] = Min;
+			}
+		}
+
+		// Gather the range compressed channels of each tile from their planes, and apply the remap and gamma of all of them
+		// in a single pass over the tile before storing them.
+		TextureSetCompilerImpl::ParallelForTileBands(TotalTiles, TilesPerBand, 1, NumWorkers, [&](int32 t, int32, int32 Worker)
+		{
+			if (IsCancelled())
+				return;
+
+			const FIntVector3 TileOffset = GetTileOffset(t);
+			float* ScratchData = GetScratch(Worker);
+
+			for (int32 c = 0; c < FormatChannels; c++)
+			{
+				if (RangeCompressMask & (1 << c))
+					TextureSetEncoding::StoreChannel(MakePlaneTileDesc(TileOffset, c), RangePlanes.GetData(), MakeScratchTileDesc(TileOffset, c), (uint8*)ScratchData, TSF_R32F, false);
+			}
+
+			TextureSetEncoding::EncodePixels(MakeScratchTileDesc(TileOffset, 0), ScratchData, CompressMul, CompressAdd, RemapMask, GammaEncodeMask & RangeCompressMask, bFastGammaEncode);
+
+			for (int32 c = 0; c < FormatChannels; c++)
+			{
+				if (RangeCompressMask & (1 << c))
+					TextureSetEncoding::StoreChannel(MakeScratchTileDesc(TileOffset, c), ScratchData, MakeDestTileDesc(TileOffset, c), SourceData, Format, (SRGBStoreMask & (1 << c)) != 0);
+			}
+		});
+
+		// Planes are full resolution, so don't hold on to them while the source is cached
+		RangePlanes.Empty();
+
+		#if BENCHMARK_TEXTURESET_COMPILATION
+		UE_LOG(LogTextureSet, Log, TEXT("%s Build: Range compression took %fs"), *DebugContext, FPlatformTime::Seconds() - SectionStartTime);
+		SectionStartTime = FPlatformTime::Seconds();
+		#endif
+	}
+
+	if (IsCancelled())
+	{
+		// The source is only partially written, so free it (leaving it initialized but not generated, like FreeTextureSource)
+		// rather than holding a full size buffer until it's next initialized, and don't cache any of it
+		Source.UnlockMip(0);
+
+		for (const TSharedRef<ITextureProcessingNode>& CachedTexture : CachedTextures)
+			CachedTexture->ReleaseCache();
+
+		Source.Init(Width, Height, Slices, Source.GetNumMips(), Format, FUniqueBuffer::Alloc(0).MoveToShared());
+		Source.SetId(GetTextureDataId(Index), true);
+
+		UE_LOG(LogTextureSet, Log, TEXT("%s: Generation cancelled after %fs"), *DerivedTexture.Texture->GetName(), FPlatformTime::Seconds() - GenerateStartTime);
+		return;
+	}
+
+	// Store the generated channels in the channel cache, for the next time only some of them change
+	const uint8 ChannelCacheStoreMask = ChannelCacheMask & ~ChannelCacheHitMask;
+	if (ChannelCacheStoreMask)
+	{
+		using namespace UE::DerivedData;
+
+		const FSharedString RequestName(Args->DebugContext);
+		TArray<FCachePutValueRequest> PutRequests;
+
+		for (int c = 0; c < 4; c++)
+		{
+			if (!(ChannelCacheStoreMask & (1 << c)))
+				continue;
+
+			FUniqueBuffer ChannelData = FUniqueBuffer::Alloc(sizeof(TextureSetCompilerImpl::FChannelCacheHeader) + NumPixels * ElementSize);
+			TextureSetCompilerImpl::FChannelCacheHeader* Header = (TextureSetCompilerImpl::FChannelCacheHeader*)ChannelData.GetData();
+			Header->RestoreMul = RestoreMul[c];
+			Header->RestoreAdd = RestoreAdd[c];
+
+			TextureSetCompilerImpl::CopyInterleavedElements(
+				SourceData + TextureSetEncoding::GetSourceFormatChannelIndex(Format, c) * ElementSize, FormatChannels,
+				(uint8*)ChannelData.GetData() + sizeof(TextureSetCompilerImpl::FChannelCacheHeader), 1,
+				ElementSize, NumPixels);
+
+			const FCacheKey Key = TextureSetCompilerImpl::MakeChannelCacheKey(ComputeChannelDataId(Index, c, TextureSize));
+			PutRequests.Add({RequestName, Key, FValue::Compress(ChannelData.MoveToShared())});
+		}
+
+		// Stores complete in the background, nothing here depends on them
+		FRequestOwner PutOwner(EPriority::Normal);
+		GetCache().PutValue(PutRequests, PutOwner);
+		PutOwner.KeepAlive();
+
+		#if BENCHMARK_TEXTURESET_COMPILATION
+		UE_LOG(LogTextureSet, Log, TEXT("%s Build: Storing %i channels in the channel cache took %fs"), *DebugContext, FMath::CountBits(ChannelCacheStoreMask), FPlatformTime::Seconds() - SectionStartTime);
+		SectionStartTime = FPlatformTime::Seconds();
+		#endif
+	}
 
 	FDerivedTextureData& Data = DerivedTexture.Data;
 	Data.Id = GetTextureDataId(Index);
@@ -500,14 +1339,196 @@ void FTextureSetCompiler::GenerateTextureSource(FDerivedTexture& DerivedTexture,
 		Data.TextureParameters.Add(TextureInfo.RangeCompressAddName, RestoreAdd);
 	}
 
+	// When nothing varies, let the material use the constant values directly and skip sampling the texture.
+	// The (collapsed) texture is still bound, for anything that samples it outside of the decode node.
+	if (ConstantChannelMask == 0xF)
+	{
+		Data.TextureParameters.Add(TextureInfo.ConstantEnabledName, FVector4f(1, 0, 0, 0));
+		Data.TextureParameters.Add(TextureInfo.ConstantValueName, DecodedConstantValues);
+	}
+
+	// Compress the source for the source cache while it's still locked, if it was expensive enough to be worth fetching later.
+	// Record is the derived texture data and generation time, followed by the source.
+	const double GenerateSeconds = FPlatformTime::Seconds() - GenerateStartTime;
+	UE::DerivedData::FValue SourceCacheValue;
+	if (bUseSourceCache && GenerateSeconds >= CVarSourceCacheMinSeconds.GetValueOnAnyThread())
+	{
+		TArray<uint8> RecordHeader;
+		FMemoryWriter RecordWriter(RecordHeader);
+		double RecordGenerateSeconds = GenerateSeconds;
+		RecordWriter << Data;
+		RecordWriter << RecordGenerateSeconds;
+
+		SourceCacheValue = UE::DerivedData::FValue::Compress(FCompositeBuffer(
+			MakeSharedBufferFromArray(MoveTemp(RecordHeader)),
+			FSharedBuffer::MakeView(SourceData, Source.CalcMipSize(0))));
+	}
+
+	Source.UnlockMip(0);
+
+	// Source data isn't needed anymore, so let it be freed rather than held for the rest of the compile
+	for (const TSharedRef<ITextureProcessingNode>& CachedTexture : CachedTextures)
+		CachedTexture->ReleaseCache();
+
+	// UnlockMip causes GUID to be set from a hash, so force it back to the one we want to use
+	Source.SetId(GetTextureDataId(Index), true);
+
+	if (SourceCacheValue.HasData())
+	{
+		using namespace UE::DerivedData;
+
+		const int64 StoredBytes = (int64)SourceCacheValue.GetData().GetCompressedSize();
+
+		FRequestOwner PutOwner(EPriority::Normal);
+		GetCache().PutValue({{FSharedString(Args->DebugContext), TextureSetCompilerImpl::MakeSourceCacheKey(GetTextureDataId(Index)), MoveTemp(SourceCacheValue)}}, PutOwner);
+		PutOwner.KeepAlive();
+
+		TextureSetCompilerImpl::SourceCacheBytesStored += StoredBytes;
+
+		UE_LOG(LogTextureSet, Log, TEXT("%s: Stored generated source in the DDC, %lld bytes (%lld uncompressed), generation took %fs. %lldKB stored in total."),
+			*DerivedTexture.Texture->GetName(), StoredBytes, Source.CalcMipSize(0), GenerateSeconds, TextureSetCompilerImpl::SourceCacheBytesStored.load() / 1024);
+	}
+
 #if BENCHMARK_TEXTURESET_COMPILATION
 	const double BuildEndTime = FPlatformTime::Seconds();
 	UE_LOG(LogTextureSet, Log, TEXT("%s: texture generation took %fs"), *DebugContext, BuildEndTime - BuildStartTime);
+
+	if (TileCache.IsValid())
+	{
+		UE_LOG(LogTextureSet, Log, TEXT("%s: tile cache has %lld hits and %lld misses so far, using %lldKB"), *DebugContext,
+			TileCache->GetHits(), TileCache->GetMisses(), TileCache->GetUsedBytes() / 1024);
+	}
 #endif
 
 	DerivedTexture.TextureState = EDerivedTextureState::SourceGenerated;
 }
 
+bool FTextureSetCompiler::UsesGenerationCaches() const
+{
+	return (CVarChannelCache.GetValueOnAnyThread() || CVarSourceCache.GetValueOnAnyThread()) && !IsPreview();
+}
+
+uint8 FTextureSetCompiler::GetChannelCacheMask(int Index) const
+{
+	if (!UsesGenerationCaches())
+		return 0;
+
+	const FTextureSetPackedTextureInfo TextureInfo = Args->PackingInfo.GetPackedTextureInfo(Index);
+	const TMap<FName, TSharedRef<ITextureProcessingNode>>& OutputTextures = GraphInstance->GetOutputTextures();
+	const int32 FormatChannels = TextureSetEncoding::GetSourceFormatChannels(GetTextureSourceFormat(Index));
+
+	// Constant channels are cheaper to fill than to fetch
+	FVector4f ConstantValues;
+	const uint8 ConstantChannelMask = GetConstantChannels(Index, ConstantValues);
+	uint8 ChannelCacheMask = 0;
+
+	for (int c = 0; c < FMath::Min(TextureInfo.ChannelCount, FormatChannels); c++)
+	{
+		if (!(ConstantChannelMask & (1 << c)) && OutputTextures.Contains(TextureInfo.ChannelInfo[c].ProcessedTexture))
+			ChannelCacheMask |= 1 << c;
+	}
+
+	return ChannelCacheMask;
+}
+
+void FTextureSetCompiler::FetchGenerationCacheData(TConstArrayView<int32> Indices, TArrayView<FTextureSetGenerationCacheData> OutData) const
+{
+	using namespace UE::DerivedData;
+
+	check(bPrepared);
+	check(Indices.Num() == OutData.Num());
+
+	const FSharedString RequestName(Args->DebugContext);
+
+	const bool bUseSourceCache = CVarSourceCache.GetValueOnAnyThread() && !IsPreview();
+
+	// UserData is the position of the texture in Indices times GenerationCacheSlots, plus the packed channel or SourceCacheSlot
+	TArray<FCacheGetValueRequest> Requests;
+
+	for (int32 i = 0; i < Indices.Num(); i++)
+	{
+		const int32 Index = Indices[i];
+		const uint8 ChannelCacheMask = GetChannelCacheMask(Index);
+		const FIntVector3 TextureSize = GetTextureSourceSize(Index);
+
+		OutData[i].bFetched = true;
+
+		for (int c = 0; c < 4; c++)
+		{
+			if (ChannelCacheMask & (1 << c))
+			{
+				const FCacheKey Key = TextureSetCompilerImpl::MakeChannelCacheKey(ComputeChannelDataId(Index, c, TextureSize));
+				Requests.Add({RequestName, Key, ECachePolicy::Default, (uint64)(i * TextureSetCompilerImpl::GenerationCacheSlots + c)});
+			}
+		}
+
+		if (bUseSourceCache)
+		{
+			const FCacheKey Key = TextureSetCompilerImpl::MakeSourceCacheKey(GetTextureDataId(Index));
+			Requests.Add({RequestName, Key, ECachePolicy::Default, (uint64)(i * TextureSetCompilerImpl::GenerationCacheSlots + TextureSetCompilerImpl::SourceCacheSlot)});
+		}
+	}
+
+	if (Requests.IsEmpty())
+		return;
+
+	// Each response writes its own slot, so they don't need to be synchronized
+	FRequestOwner Owner(EPriority::Normal);
+	GetCache().GetValue(Requests, Owner, [&OutData](FCacheGetValueResponse&& Response)
+	{
+		if (Response.Status != EStatus::Ok)
+			return;
+
+		const int32 i = (int32)(Response.UserData / TextureSetCompilerImpl::GenerationCacheSlots);
+		const int32 Slot = (int32)(Response.UserData % TextureSetCompilerImpl::GenerationCacheSlots);
+		FSharedBuffer Data = Response.Value.GetData().Decompress();
+
+		if (Slot == TextureSetCompilerImpl::SourceCacheSlot)
+			OutData[i].Source = MoveTemp(Data);
+		else
+			OutData[i].Channels[Slot] = MoveTemp(Data);
+	});
+
+	WaitForRequests(Owner);
+}
+
+bool FTextureSetCompiler::RestoreTextureSource(FDerivedTexture& DerivedTexture, int Index, const FSharedBuffer& Record) const
+{
+	const double FetchStartTime = FPlatformTime::Seconds();
+
+	FMemoryReaderView RecordReader(Record.GetView());
+	FDerivedTextureData Data;
+	double GenerateSeconds = 0;
+	RecordReader << Data;
+	RecordReader << GenerateSeconds;
+
+	if (RecordReader.IsError())
+		return false;
+
+	const FMemoryView SourceData = Record.GetView().RightChop(RecordReader.Tell());
+
+	FTextureSource& Source = DerivedTexture.Texture->Source;
+
+	// Source should already be initialized to the right size and format, so anything else isn't what we expect
+	if (SourceData.GetSize() != Source.CalcMipSize(0) || Source.GetNumMips() != 1)
+		return false;
+
+	Source.Init(Source.GetSizeX(), Source.GetSizeY(), Source.GetNumSlices(), 1, Source.GetFormat(), (const uint8*)SourceData.GetData());
+
+	// Initializing source resets the ID, so put it back
+	Source.SetId(GetTextureDataId(Index), true);
+
+	DerivedTexture.Data = Data;
+
+	const double FetchSeconds = FPlatformTime::Seconds() - FetchStartTime;
+	TextureSetCompilerImpl::SourceCacheMicrosecondsSaved += (int64)((GenerateSeconds - FetchSeconds) * 1e6);
+
+	UE_LOG(LogTextureSet, Log, TEXT("%s: Restored generated source from the DDC in %fs instead of generating it in %fs. %fs saved in total."),
+		*DerivedTexture.Texture->GetName(), FetchSeconds, GenerateSeconds, TextureSetCompilerImpl::SourceCacheMicrosecondsSaved.load() / 1e6);
+
+	return true;
+}
+
 void FTextureSetCompiler::FreeTextureSource(FDerivedTexture& DerivedTexture, int Index) const
 {
 	check(DerivedTexture.TextureState >= EDerivedTextureState::SourceInitialized);
@@ -534,6 +1555,8 @@ FDerivedParameterData FTextureSetCompiler::BuildParameterData(FName Name) const
 
 	FDerivedParameterData ParameterData;
 	ParameterData.Value = Parameter->GetValue();
+
+	Parameter->ReleaseCache();
 	ParameterData.Id = GetParameterDataId(Name);
 	return ParameterData;
 }
@@ -2,81 +2,63 @@
 
 #include "TextureSetCompilerTask.h"
 
-#include "DerivedDataBuildVersion.h"
-#include "DerivedDataCacheInterface.h"
+#include "DerivedDataCache.h"
+#include "DerivedDataCacheKey.h"
+#include "DerivedDataRequestOwner.h"
+#include "DerivedDataValue.h"
 #include "Engine/Texture2D.h"
 #include "Engine/Texture2DArray.h"
+#include "IO/IoHash.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tasks/Task.h"
 #include "TextureSetCompiler.h"
 #include "TextureSetDerivedData.h"
 #include "TextureSetTextureSourceProvider.h"
 
-class TextureSetDerivedTextureDataPlugin : public FDerivedDataPluginInterface
+namespace TextureSetCompilerTaskImpl
 {
-public:
-	TextureSetDerivedTextureDataPlugin(const FTextureSetCompiler& Compiler, FDerivedTexture& DerivedTexture, int32 DerivedTextureIndex)
-		: Compiler(Compiler)
-		, DerivedTexture(DerivedTexture)
-		, DerivedTextureIndex(DerivedTextureIndex)
-	{}
-
-	// FDerivedDataPluginInterface
-	virtual const TCHAR* GetPluginName() const override { return TEXT("TextureSet_FDerivedTextureData"); }
-	virtual const TCHAR* GetVersionString() const override { return TEXT("F956B1B9-3AD3-47B3-BD82-8826C71A3DCB"); }
-	virtual FString GetPluginSpecificCacheKeySuffix() const override { return Compiler.GetTextureDataId(DerivedTextureIndex).ToString(); }
-	virtual bool IsBuildThreadsafe() const override { return false; }
-	virtual bool IsDeterministic() const override { return true; }
-	virtual FString GetDebugContextString() const override { return Compiler.Args->DebugContext; }
-	
-	virtual bool Build(TArray<uint8>& OutData) override
+	// Bump these to invalidate all cached derived data of that type
+	static const TCHAR* TextureDataVersion = TEXT("F956B1B9-3AD3-47B3-BD82-8826C71A3DCB");
+	static const TCHAR* ParameterDataVersion = TEXT("8D5EAAD9-8514-4957-B931-C7AF2698794F");
+
+	static UE::DerivedData::FCacheKey MakeCacheKey(const UE::DerivedData::FCacheBucket& Bucket, const TCHAR* Version, const FGuid& DataId)
 	{
-		FTextureSource& Source = DerivedTexture.Texture->Source;
+		FIoHashBuilder HashBuilder;
+		HashBuilder.Update(Version, FCString::Strlen(Version) * sizeof(TCHAR));
+		HashBuilder.Update(&DataId, sizeof(FGuid));
+		return {Bucket, HashBuilder.Finalize()};
+	}
 
+	static TArray<uint8> BuildTextureData(const FTextureSetCompiler& Compiler, FDerivedTexture& DerivedTexture, int32 Index, FTextureSetGenerationCacheData& GenerationCacheData)
+	{
 		if (DerivedTexture.TextureState < EDerivedTextureState::SourceInitialized)
-			Compiler.InitializeTextureSource(DerivedTexture, DerivedTextureIndex);
+			Compiler.InitializeTextureSource(DerivedTexture, Index);
+
+		Compiler.GenerateTextureSource(DerivedTexture, Index, &GenerationCacheData);
 
-		Compiler.GenerateTextureSource(DerivedTexture, DerivedTextureIndex);
+		// Cancelled generation leaves no data worth caching
+		if (DerivedTexture.TextureState < EDerivedTextureState::SourceGenerated)
+			return TArray<uint8>();
 
-		OutData.Empty(2048);
-		FMemoryWriter DataWriter(OutData);
+		TArray<uint8> Data;
+		Data.Empty(2048);
+		FMemoryWriter DataWriter(Data);
 		DataWriter << DerivedTexture.Data;
-		return true;
+		return Data;
 	}
 
-private:
-	const FTextureSetCompiler& Compiler;
-	FDerivedTexture& DerivedTexture;
-	const int32 DerivedTextureIndex;
-};
-
-class TextureSetDerivedParameterDataPlugin : public FDerivedDataPluginInterface
-{
-public:
-	TextureSetDerivedParameterDataPlugin(const FTextureSetCompiler& Compiler, FName ParameterName)
-		: Compiler(Compiler)
-		, ParameterName(ParameterName)
-	{}
-
-	// FDerivedDataPluginInterface
-	virtual const TCHAR* GetPluginName() const override { return TEXT("TextureSet_FDerivedTextureData"); }
-	virtual const TCHAR* GetVersionString() const override { return TEXT("8D5EAAD9-8514-4957-B931-C7AF2698794F"); }
-	virtual FString GetPluginSpecificCacheKeySuffix() const override { return Compiler.GetParameterDataId(ParameterName).ToString(); }
-	virtual bool IsBuildThreadsafe() const override { return false; }
-	virtual bool IsDeterministic() const override { return true; }
-	virtual FString GetDebugContextString() const override { return Compiler.Args->DebugContext; }
-	virtual bool Build(TArray<uint8>& OutData) override
+	static TArray<uint8> BuildParameterData(const FTextureSetCompiler& Compiler, FName ParameterName)
 	{
 		FDerivedParameterData ParameterData = Compiler.BuildParameterData(ParameterName);
 
-		OutData.Empty(sizeof(FDerivedParameterData));
-		FMemoryWriter DataReader(OutData);
-		DataReader << ParameterData;
-		return true;
+		TArray<uint8> Data;
+		Data.Empty(sizeof(FDerivedParameterData));
+		FMemoryWriter DataWriter(Data);
+		DataWriter << ParameterData;
+		return Data;
 	}
-
-private:
-	const FTextureSetCompiler& Compiler;
-	const FName ParameterName;
-};
+}
 
 FTextureSetCompilerTaskWorker::FTextureSetCompilerTaskWorker (TSharedRef<FTextureSetCompiler> Compiler, UTextureSetDerivedData* DerivedData, bool bIsDefaultTextureSet)
 	: Compiler(Compiler)
@@ -86,49 +68,153 @@ FTextureSetCompilerTaskWorker::FTextureSetCompilerTaskWorker (TSharedRef<FTextur
 
 void FTextureSetCompilerTaskWorker::DoWork()
 {
-	FDerivedDataCacheInterface& DDC = GetDerivedDataCacheRef();
+	using namespace UE::DerivedData;
+
+	static const FCacheBucket TextureBucket(TEXT("TextureSetTexture"));
+	static const FCacheBucket ParameterBucket(TEXT("TextureSetParameter"));
+
+	const int32 NumTextures = Compiler->Args->PackingInfo.NumPackedTextures();
+	const TArray<FName> ParameterNames = Compiler->GetAllParameterNames();
+	const FSharedString RequestName(Compiler->Args->DebugContext);
+
+	// Previews are cheap to build and short lived, so they skip the cache entirely rather than fill it with throwaway data
+	const bool bUseCache = !Compiler->IsPreview();
+	const ECachePolicy Policy = bUseCache ? ECachePolicy::Default : ECachePolicy::None;
+
+	// Look up all the derived data of the texture set in a single batch, so we only wait on the cache's latency once.
+	// UserData is the texture index, or the number of textures plus the parameter index.
+	TArray<FCacheGetValueRequest> Requests;
+	Requests.Reserve(NumTextures + ParameterNames.Num());
 
-	ParallelForWithPreWork(
-	Compiler->Args->PackingInfo.NumPackedTextures(),
-	[&](int32 t) // Parallel For
+	for (int32 t = 0; t < NumTextures; t++)
+		Requests.Add({RequestName, TextureSetCompilerTaskImpl::MakeCacheKey(TextureBucket, TextureSetCompilerTaskImpl::TextureDataVersion, Compiler->GetTextureDataId(t)), Policy, (uint64)t});
+
+	for (int32 p = 0; p < ParameterNames.Num(); p++)
+		Requests.Add({RequestName, TextureSetCompilerTaskImpl::MakeCacheKey(ParameterBucket, TextureSetCompilerTaskImpl::ParameterDataVersion, Compiler->GetParameterDataId(ParameterNames[p])), Policy, (uint64)(NumTextures + p)});
+
+	// Misses are built as their responses arrive, and the results are put back in the cache without waiting on them
+	FRequestOwner PutOwner(EPriority::Normal);
+	FCriticalSection BuildTasksCS;
+	TArray<UE::Tasks::FTask> BuildTasks;
+
+	auto PutData = [&PutOwner, &RequestName, bUseCache](const FCacheKey& Key, const TArray<uint8>& Data)
 	{
-		// Retreive derived data from the DDC, or compute new data
-		FDerivedTexture& DerivedTexture = DerivedData->Textures[t];
-		FScopeLock Lock(DerivedTexture.TextureCS.Get());
-		TArray<uint8> Data;
-		if (DDC.GetSynchronous(new TextureSetDerivedTextureDataPlugin(Compiler.Get(), DerivedTexture, t), Data))
+		if (Data.IsEmpty() || !bUseCache)
+			return;
+
+		FCachePutValueRequest PutRequest = {RequestName, Key, FValue::Compress(FSharedBuffer::Clone(Data.GetData(), Data.Num()))};
+		GetCache().PutValue({PutRequest}, PutOwner);
+	};
+
+	auto LaunchTextureTask = [&](int32 TextureIndex, const FCacheKey& Key, FSharedBuffer CachedData, FTextureSetGenerationCacheData GenerationCacheData)
+	{
+		UE::Tasks::FTask BuildTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, TextureIndex, Key, CachedData, GenerationCacheData, &PutData]() mutable
 		{
-			// De-serialized the data from the cache into the derived texture data
-			FMemoryReader DataReader(Data);
-			DataReader << DerivedTexture.Data;
-		}
+			// May have been cancelled while queued
+			if (Compiler->IsCancelled())
+				return;
+
+			// Retreive derived data from the cache, or compute new data
+			FDerivedTexture& DerivedTexture = DerivedData->Textures[TextureIndex];
+			FScopeLock Lock(DerivedTexture.TextureCS.Get());
+
+			if (!CachedData.IsNull())
+			{
+				// De-serialized the data from the cache into the derived texture data
+				FMemoryReaderView DataReader(CachedData.GetView());
+				DataReader << DerivedTexture.Data;
+			}
+			else
+			{
+				PutData(Key, TextureSetCompilerTaskImpl::BuildTextureData(Compiler.Get(), DerivedTexture, TextureIndex, GenerationCacheData));
+			}
 
-		// For default texture sets, we need to ensure they have valid source
-		// data, since we will be not have a UTextureSetTextureSourceProvider.
-		if (bIsDefaultTextureSet && DerivedTexture.TextureState < EDerivedTextureState::SourceGenerated)
+			// For default texture sets, we need to ensure they have valid source
+			// data, since we will be not have a UTextureSetTextureSourceProvider.
+			if (bIsDefaultTextureSet && DerivedTexture.TextureState < EDerivedTextureState::SourceGenerated)
+			{
+				Compiler->GenerateTextureSource(DerivedTexture, TextureIndex, &GenerationCacheData);
+			}
+		});
+
+		FScopeLock Lock(&BuildTasksCS);
+		BuildTasks.Add(BuildTask);
+	};
+
+	// Textures which have to be generated, when their previously generated data has to be looked up first
+	const bool bFetchGenerationCaches = Compiler->UsesGenerationCaches();
+	TArray<int32> GenerateIndices;
+
+	FRequestOwner GetOwner(EPriority::Normal);
+	GetCache().GetValue(Requests, GetOwner, [&](FCacheGetValueResponse&& Response)
+	{
+		const int32 RequestIndex = (int32)Response.UserData;
+
+		// Once cancelled, the remaining responses are dropped rather than built. The derived data is thrown away.
+		if (Compiler->IsCancelled())
+			return;
+
+		const bool bHit = Response.Status == EStatus::Ok;
+		FSharedBuffer CachedData = bHit ? Response.Value.GetData().Decompress() : FSharedBuffer();
+
+		if (RequestIndex < NumTextures)
 		{
-			Compiler->GenerateTextureSource(DerivedData->Textures[t], t);
+			if (!bHit && bFetchGenerationCaches)
+			{
+				FScopeLock Lock(&BuildTasksCS);
+				GenerateIndices.Add(RequestIndex);
+				return;
+			}
+
+			LaunchTextureTask(RequestIndex, Response.Key, CachedData, FTextureSetGenerationCacheData());
 		}
-	},
-	[&]() // Pre-Work
-	{
-		FScopeLock Lock(&DerivedData->ParameterCS);
-		for (FName Name : Compiler->GetAllParameterNames())
+		else
 		{
-			FDerivedParameterData* OldParameterData = DerivedData->MaterialParameters.Find(Name);
+			const FName Name = ParameterNames[RequestIndex - NumTextures];
+
+			// Parameters are cheap to build, so don't bother with a task
+			FDerivedParameterData NewParameterData;
 
-			// Retreive derived data from the DDC, or compile new data
-			TArray<uint8> Data;
-			if (DDC.GetSynchronous(new TextureSetDerivedParameterDataPlugin(Compiler.Get(), Name), Data))
+			if (!CachedData.IsNull())
 			{
-				// De-serialized the data from the cache into the derived data
-				FDerivedParameterData NewParameterData;
+				FMemoryReaderView DataReader(CachedData.GetView());
+				DataReader << NewParameterData;
+			}
+			else
+			{
+				const TArray<uint8> Data = TextureSetCompilerTaskImpl::BuildParameterData(Compiler.Get(), Name);
 				FMemoryReader DataReader(Data);
 				DataReader << NewParameterData;
-				DerivedData->MaterialParameters.Emplace(Name, NewParameterData);
+				PutData(Response.Key, Data);
 			}
+
+			FScopeLock Lock(&DerivedData->ParameterCS);
+			DerivedData->MaterialParameters.Emplace(Name, NewParameterData);
 		}
 	});
+
+	// All responses have arrived once the get completes, so all the build tasks have been launched.
+	// Cancelling the compile cancels the outstanding gets, so it doesn't have to wait on a slow cache.
+	Compiler->WaitForRequests(GetOwner);
+
+	// Previously generated data (e.g. cached channels) of the textures that missed is looked up in a second batch, rather than
+	// with the first, so textures whose derived data was found don't download data they'll never use.
+	if (!GenerateIndices.IsEmpty() && !Compiler->IsCancelled())
+	{
+		TArray<FTextureSetGenerationCacheData> GenerationCacheData;
+		GenerationCacheData.SetNum(GenerateIndices.Num());
+		Compiler->FetchGenerationCacheData(GenerateIndices, GenerationCacheData);
+
+		for (int32 i = 0; i < GenerateIndices.Num(); i++)
+		{
+			const int32 t = GenerateIndices[i];
+			const FCacheKey Key = TextureSetCompilerTaskImpl::MakeCacheKey(TextureBucket, TextureSetCompilerTaskImpl::TextureDataVersion, Compiler->GetTextureDataId(t));
+			LaunchTextureTask(t, Key, FSharedBuffer(), MoveTemp(GenerationCacheData[i]));
+		}
+	}
+
+	UE::Tasks::Wait(BuildTasks);
+	PutOwner.Wait();
 }
 
 TextureSetCompilerTask::TextureSetCompilerTask(TSharedRef<FTextureSetCompiler> Compiler, bool bIsDefaultTextureSet)
@@ -138,6 +224,8 @@ TextureSetCompilerTask::TextureSetCompilerTask(TSharedRef<FTextureSetCompiler> C
 	, bHasBeganTextureCache(false)
 	, bHasAddedSourceProviders(false)
 	, bHasFinalized(false)
+	, EstimatedPeakMemory(0)
+	, Priority(EQueuedWorkPriority::Normal)
 {
 }
 
@@ -154,6 +242,7 @@ void TextureSetCompilerTask::StartAsync(FQueuedThreadPool* InQueuedPool, EQueued
 	CreateDerivedData();
 	AsyncTask = MakeUnique<FAsyncTask<FTextureSetCompilerTaskWorker>>(Compiler, DerivedData.Get(), bIsDefaultTextureSet);
 
+	Priority = InQueuedWorkPriority;
 	AsyncTask->StartBackgroundTask(InQueuedPool, InQueuedWorkPriority);
 }
 
@@ -226,6 +315,11 @@ bool TextureSetCompilerTask::TryFinalize()
 	return true;
 }
 
+void TextureSetCompilerTask::RequestCancel()
+{
+	Compiler->Cancel();
+}
+
 void TextureSetCompilerTask::Finalize()
 {
 	check(AsyncTask);
@@ -254,10 +348,12 @@ void TextureSetCompilerTask::CreateDerivedData()
 	check(!DerivedData.IsValid()); // Data should not have been created yet
 
 	Compiler->Prepare();
+	EstimatedPeakMemory = Compiler->EstimatePeakMemory();
 
 	const int NumDerivedTextures = Compiler->Args->PackingInfo.NumPackedTextures();
 
 	DerivedData.Reset(NewObject<UTextureSetDerivedData>());
+	DerivedData->bIsPreview = Compiler->IsPreview();
 	DerivedData->Textures.SetNum(NumDerivedTextures);
 
 	// Create the UTextures
@@ -0,0 +1,299 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Texture.h"
+#include "ImageCore.h"
+#include "ProcessingNodes/TextureDataTileDesc.h"
+#include "TextureSetInfo.h"
+#include "TextureSetPackedTextureDef.h"
+
+// Kernels for the channel encoding applied to generated texture data.
+// Decoding happens in FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode
+namespace TextureSetEncoding
+{
+	static constexpr float GammaEncodeExponent = 1.0f / 2.2f;
+
+	FORCEINLINE float GammaEncode(float Value)
+	{
+		return FMath::Pow(Value, GammaEncodeExponent);
+	}
+
+	// Approximates Pow(X, 1 / 2.2) for 4 values at once, as Exp2(Log2(X) / 2.2) with polynomial approximations of Log2 and Exp2.
+	// Measured against a double precision reference, the maximum absolute error is 7.2e-7 for inputs in [0, 1] (well below
+	// the 1.5e-5 step of a 16 bit channel), and the maximum relative error is 4.1e-6 for inputs in [0, 1024].
+	// Zero, negative and denormal inputs return 0.
+	FORCEINLINE VectorRegister4Float VectorGammaEncode(const VectorRegister4Float& X)
+	{
+		// Split X into exponent and mantissa, with the mantissa in [1, 2)
+		const VectorRegister4Int Bits = VectorCastFloatToInt(X);
+		const VectorRegister4Int Exponent = VectorIntSubtract(VectorShiftRightImmLogical(Bits, 23), VectorIntSet1(127));
+		const VectorRegister4Float Mantissa = VectorCastIntToFloat(VectorIntOr(VectorIntAnd(Bits, VectorIntSet1(0x007FFFFF)), VectorIntSet1(0x3F800000)));
+
+		// Log2(1 + T) for T in [0, 1), max error 1.8e-6
+		const VectorRegister4Float T = VectorSubtract(Mantissa, GlobalVectorConstants::FloatOne);
+		VectorRegister4Float Log2 = VectorSetFloat1(-0.025691205635666847f);
+		Log2 = VectorMultiplyAdd(Log2, T, VectorSetFloat1(0.12100262939929962f));
+		Log2 = VectorMultiplyAdd(Log2, T, VectorSetFloat1(-0.27654123306274414f));
+		Log2 = VectorMultiplyAdd(Log2, T, VectorSetFloat1(0.4565219581127167f));
+		Log2 = VectorMultiplyAdd(Log2, T, VectorSetFloat1(-0.7177911996841431f));
+		Log2 = VectorMultiplyAdd(Log2, T, VectorSetFloat1(1.442495346069336f));
+		Log2 = VectorMultiplyAdd(Log2, T, VectorSetFloat1(1.845184442572645e-06f));
+		Log2 = VectorAdd(Log2, VectorIntToFloat(Exponent));
+
+		// Exp2(Y) split into 2^Floor(Y) * 2^Fraction, with 2^Fraction for Fraction in [0, 1), max relative error 1.1e-7
+		const VectorRegister4Float Y = VectorMultiply(Log2, VectorSetFloat1(GammaEncodeExponent));
+		const VectorRegister4Float YFloor = VectorFloor(Y);
+		const VectorRegister4Float Fraction = VectorSubtract(Y, YFloor);
+		VectorRegister4Float Exp2 = VectorSetFloat1(0.0018964613554999232f);
+		Exp2 = VectorMultiplyAdd(Exp2, Fraction, VectorSetFloat1(0.008942827582359314f));
+		Exp2 = VectorMultiplyAdd(Exp2, Fraction, VectorSetFloat1(0.05586624890565872f));
+		Exp2 = VectorMultiplyAdd(Exp2, Fraction, VectorSetFloat1(0.24013970792293549f));
+		Exp2 = VectorMultiplyAdd(Exp2, Fraction, VectorSetFloat1(0.6931547522544861f));
+		Exp2 = VectorMultiplyAdd(Exp2, Fraction, VectorSetFloat1(0.9999998807907104f));
+
+		// Scale by 2^Floor(Y) by adding directly to the exponent bits
+		const VectorRegister4Int ScaledBits = VectorIntAdd(VectorCastFloatToInt(Exp2), VectorShiftLeftImm(VectorFloatToInt(YFloor), 23));
+		const VectorRegister4Float Result = VectorCastIntToFloat(ScaledBits);
+
+		// Inputs below the smallest normal float (including zero and negatives) return 0
+		const VectorRegister4Float IsNormal = VectorCompareGE(X, VectorSetFloat1(FLT_MIN));
+		return VectorSelect(IsNormal, Result, GlobalVectorConstants::FloatZero);
+	}
+
+	// Gamma encodes a single channel of interleaved data in the tile.
+	// Only the channel's own values are read and written, so other channels of the same pixels may be written concurrently.
+	inline void GammaEncodeChannel(const FTextureDataTileDesc& Tile, float* Data, bool bFast)
+	{
+		if (!bFast)
+		{
+			Tile.ForEachPixel([Data](FTextureDataTileDesc::ForEachPixelContext& Context)
+			{
+				Data[Context.DataIndex] = GammaEncode(Data[Context.DataIndex]);
+			});
+			return;
+		}
+
+		const int64 PixelStride = Tile.TileDataStride.X;
+
+		for (int32 Z = 0; Z < Tile.TileSize.Z; Z++)
+		{
+			for (int32 Y = 0; Y < Tile.TileSize.Y; Y++)
+			{
+				float* Row = Data + Tile.TileCoordToDataIndex(FIntVector(0, Y, Z));
+
+				// Gather 4 pixels of the channel at a time. The remainder of the row runs through the same kernel
+				// so every value is encoded identically regardless of it's position in the tile.
+				for (int32 X = 0; X < Tile.TileSize.X; X += 4)
+				{
+					const int32 NumValues = FMath::Min(4, Tile.TileSize.X - X);
+					alignas(16) float Values[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+					for (int32 i = 0; i < NumValues; i++)
+						Values[i] = Row[(X + i) * PixelStride];
+
+					VectorStoreAligned(VectorGammaEncode(VectorLoadAligned(Values)), Values);
+
+					for (int32 i = 0; i < NumValues; i++)
+						Row[(X + i) * PixelStride] = Values[i];
+				}
+			}
+		}
+	}
+
+	// Encodes all channels of each RGBA pixel in the tile, where the tile's data index points at the first channel of a pixel.
+	// Channels in RemapMask are transformed by Value * Mul + Add, and then channels in GammaMask are gamma encoded.
+	inline void EncodePixels(const FTextureDataTileDesc& Tile, float* Data, const FVector4f& Mul, const FVector4f& Add, uint8 RemapMask, uint8 GammaMask, bool bFast)
+	{
+		check(Tile.TileDataStride.X == 4);
+
+		if (!bFast)
+		{
+			Tile.ForEachPixel([Data, &Mul, &Add, RemapMask, GammaMask](FTextureDataTileDesc::ForEachPixelContext& Context)
+			{
+				for (int32 c = 0; c < 4; c++)
+				{
+					float& Value = Data[Context.DataIndex + c];
+
+					if (RemapMask & (1 << c))
+						Value = Value * Mul[c] + Add[c];
+
+					if (GammaMask & (1 << c))
+						Value = GammaEncode(Value);
+				}
+			});
+			return;
+		}
+
+		auto MakeLaneMask = [](uint8 ChannelMask)
+		{
+			return VectorCastIntToFloat(MakeVectorRegisterInt(
+				(ChannelMask & 1) ? -1 : 0,
+				(ChannelMask & 2) ? -1 : 0,
+				(ChannelMask & 4) ? -1 : 0,
+				(ChannelMask & 8) ? -1 : 0));
+		};
+
+		const VectorRegister4Float VMul = MakeVectorRegister(Mul.X, Mul.Y, Mul.Z, Mul.W);
+		const VectorRegister4Float VAdd = MakeVectorRegister(Add.X, Add.Y, Add.Z, Add.W);
+		const VectorRegister4Float VRemapMask = MakeLaneMask(RemapMask);
+		const VectorRegister4Float VGammaMask = MakeLaneMask(GammaMask);
+
+		Tile.ForEachPixel([Data, &VMul, &VAdd, &VRemapMask, &VGammaMask](FTextureDataTileDesc::ForEachPixelContext& Context)
+		{
+			float* Pixel = Data + Context.DataIndex;
+
+			VectorRegister4Float Value = VectorLoad(Pixel);
+			// Multiply and add are kept separate so results match the scalar path exactly
+			Value = VectorSelect(VRemapMask, VectorAdd(VectorMultiply(Value, VMul), VAdd), Value);
+			Value = VectorSelect(VGammaMask, VectorGammaEncode(Value), Value);
+			VectorStore(Value, Pixel);
+		});
+	}
+
+	// Chooses the smallest texture source format that doesn't lose precision the compressed texture can represent
+	inline ETextureSourceFormat ChooseSourceFormat(const FTextureSetPackedTextureDef& TextureDef, const FTextureSetPackedTextureInfo& TextureInfo)
+	{
+		// Single channel formats are only used when the compression only has a single channel to begin with,
+		// so the contents of the other channels never matter.
+		const bool bSingleChannel = TextureDef.GetAvailableChannels() == 1 && TextureInfo.ChannelCount <= 1;
+
+		switch (TextureDef.CompressionSettings)
+		{
+		case TC_HDR:
+		case TC_HDR_Compressed:
+		case TC_HalfFloat:
+			return bSingleChannel ? TSF_R16F : TSF_RGBA16F;
+		case TC_HDR_F32:
+		case TC_SingleFloat:
+			return bSingleChannel ? TSF_R32F : TSF_RGBA32F;
+		case TC_Displacementmap:
+			return bSingleChannel ? TSF_G16 : TSF_RGBA16F;
+		case TC_Normalmap:
+			// BC5 has more than 8 bits of precision per channel
+			return TSF_RGBA16F;
+		case TC_Alpha:
+		case TC_DistanceFieldFont:
+			// These read channels other than red, so keep all of them
+			return TSF_BGRA8;
+		default:
+			return bSingleChannel ? TSF_G8 : TSF_BGRA8;
+		}
+	}
+
+	// Number of channels stored by a texture source format that we write
+	inline int32 GetSourceFormatChannels(ETextureSourceFormat Format)
+	{
+		switch (Format)
+		{
+		case TSF_G8:
+		case TSF_G16:
+		case TSF_R16F:
+		case TSF_R32F:
+			return 1;
+		case TSF_BGRA8:
+		case TSF_RGBA16F:
+		case TSF_RGBA32F:
+			return 4;
+		default:
+			unimplemented();
+			return 0;
+		}
+	}
+
+	// Texture sources in 8 bit formats are interpreted as sRGB encoded when the texture is sRGB, others are always linear
+	inline bool SourceFormatStoresSRGB(ETextureSourceFormat Format)
+	{
+		return Format == TSF_G8 || Format == TSF_BGRA8;
+	}
+
+	// Index of a channel within a pixel of the texture source format
+	inline int32 GetSourceFormatChannelIndex(ETextureSourceFormat Format, int32 Channel)
+	{
+		static constexpr int32 BGRAMap[] = { 2, 1, 0, 3 };
+		return Format == TSF_BGRA8 ? BGRAMap[Channel] : Channel;
+	}
+
+	FORCEINLINE uint8 QuantizeUnorm8(float Value)
+	{
+		return (uint8)FMath::RoundToInt(FMath::Clamp(Value, 0.0f, 1.0f) * 255.0f);
+	}
+
+	FORCEINLINE uint8 QuantizeSRGB8(float Value)
+	{
+		// Matches the curve used to decode sRGB sources (see sRGBToLinearTable in TextureRead.cpp)
+		Value = FMath::Clamp(Value, 0.0f, 1.0f);
+		Value = Value <= 0.0031308f ? Value * 12.92f : FMath::Pow(Value, 1.0f / 2.4f) * 1.055f - 0.055f;
+		return (uint8)FMath::RoundToInt(Value * 255.0f);
+	}
+
+	FORCEINLINE uint16 QuantizeUnorm16(float Value)
+	{
+		return (uint16)FMath::RoundToInt(FMath::Clamp(Value, 0.0f, 1.0f) * 65535.0f);
+	}
+
+	template <typename TDest, typename ConvertFunc>
+	static void StoreChannel(const FTextureDataTileDesc& SourceTile, const float* Source, const FTextureDataTileDesc& DestTile, TDest* Dest, const ConvertFunc& Convert)
+	{
+		check(SourceTile.TileSize == DestTile.TileSize);
+
+		int64 ISource = SourceTile.TileDataOffset;
+		int64 IDest = DestTile.TileDataOffset;
+
+		for (int32 Z = 0; Z < DestTile.TileSize.Z; Z++)
+		{
+			for (int32 Y = 0; Y < DestTile.TileSize.Y; Y++)
+			{
+				for (int32 X = 0; X < DestTile.TileSize.X; X++)
+				{
+					Dest[IDest] = Convert(Source[ISource]);
+
+					ISource += SourceTile.TileDataStepSize.X;
+					IDest += DestTile.TileDataStepSize.X;
+				}
+				ISource += SourceTile.TileDataStepSize.Y;
+				IDest += DestTile.TileDataStepSize.Y;
+			}
+			ISource += SourceTile.TileDataStepSize.Z;
+			IDest += DestTile.TileDataStepSize.Z;
+		}
+	}
+
+	// Converts one channel of float data to the texture source format, and stores it.
+	// DestTile indexes elements of the texture source format (bytes for 8 bit formats, halfs for 16 bit float formats, etc.)
+	inline void StoreChannel(const FTextureDataTileDesc& SourceTile, const float* Source, const FTextureDataTileDesc& DestTile, uint8* Dest, ETextureSourceFormat Format, bool bSRGB)
+	{
+		switch (Format)
+		{
+		case TSF_G8:
+		case TSF_BGRA8:
+			if (bSRGB)
+				StoreChannel(SourceTile, Source, DestTile, Dest, [](float Value) { return QuantizeSRGB8(Value); });
+			else
+				StoreChannel(SourceTile, Source, DestTile, Dest, [](float Value) { return QuantizeUnorm8(Value); });
+			break;
+		case TSF_G16:
+			StoreChannel(SourceTile, Source, DestTile, (uint16*)Dest, [](float Value) { return QuantizeUnorm16(Value); });
+			break;
+		case TSF_R16F:
+		case TSF_RGBA16F:
+			StoreChannel(SourceTile, Source, DestTile, (FFloat16*)Dest, [](float Value) { return FFloat16(Value); });
+			break;
+		case TSF_R32F:
+		case TSF_RGBA32F:
+			StoreChannel(SourceTile, Source, DestTile, (float*)Dest, [](float Value) { return Value; });
+			break;
+		default:
+			unimplemented();
+		}
+	}
+
+	// Fills one channel of the tile with a constant value
+	inline void FillChannel(const FTextureDataTileDesc& DestTile, uint8* Dest, ETextureSourceFormat Format, float Value, bool bSRGB)
+	{
+		// Use a zero stride source tile so every pixel reads the same value
+		const FTextureDataTileDesc SourceTile(DestTile.TextureSize, DestTile.TileSize, DestTile.TileOffset, FInt64Vector3::ZeroValue, 0);
+		StoreChannel(SourceTile, &Value, DestTile, Dest, Format, bSRGB);
+	}
+}
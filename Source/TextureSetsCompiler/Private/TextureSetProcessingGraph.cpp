@@ -3,6 +3,7 @@
 #include "TextureSetProcessingGraph.h"
 
 #include "ProcessingNodes/TextureInput.h"
+#include "ProcessingNodes/TextureRead.h"
 #include "TextureSetModule.h"
 
 FTextureSetProcessingGraph::FTextureSetProcessingGraph()
@@ -42,6 +43,8 @@ void FTextureSetProcessingGraph::Regenerate(const TArray<const UTextureSetModule
 		InputTexture->InstantiateOperators(*this);
 	}
 
+	DeduplicateOutputTextures();
+
 	bIsGenerating = false;
 	bHasGenerated = true;
 }
@@ -113,6 +116,64 @@ const TMap<FName, const IParameterProcessingNode*> FTextureSetProcessingGraph::G
 	return Result;
 }
 
+void FTextureSetProcessingGraph::DeduplicateInputs(const FTextureSetProcessingContext& Context)
+{
+	check(IsInGameThread()); // Hashing data reads UObjects
+
+	// Inputs which read the same source data with the same definition share a single read
+	TMap<FGuid, TSharedRef<FTextureRead>> UniqueReads;
+
+	for (auto& [InputName, InputTexture] : InputTextures)
+	{
+		const TSharedRef<FTextureRead>& TextureRead = InputTexture->GetTextureRead();
+
+		IProcessingNode::FHashBuilder HashBuilder;
+		HashBuilder << GetTypeHash(TextureRead->GetSourceDefinition());
+		TextureRead->ComputeDataHash(Context, HashBuilder);
+		const FGuid ReadHash = HashBuilder.Build();
+
+		if (const TSharedRef<FTextureRead>* UniqueRead = UniqueReads.Find(ReadHash))
+			InputTexture->SetTextureRead(*UniqueRead, *this);
+		else
+			UniqueReads.Add(ReadHash, TextureRead);
+	}
+
+	// Inputs which now apply identical operators to the same read share a single operator chain
+	TMap<FGuid, TSharedRef<FTextureInput>> UniqueInputs;
+
+	for (auto& [InputName, InputTexture] : InputTextures)
+	{
+		IProcessingNode::FHashBuilder HashBuilder;
+		InputTexture->ComputeGraphHash(HashBuilder);
+		const FGuid InputHash = HashBuilder.Build();
+
+		if (const TSharedRef<FTextureInput>* UniqueInput = UniqueInputs.Find(InputHash))
+			InputTexture->ShareOperators(UniqueInput->Get());
+		else
+			UniqueInputs.Add(InputHash, InputTexture);
+	}
+
+	// Outputs built on top of inputs which are now shared may have become identical
+	DeduplicateOutputTextures();
+}
+
+void FTextureSetProcessingGraph::DeduplicateOutputTextures()
+{
+	TMap<FGuid, TSharedRef<ITextureProcessingNode>> UniqueNodes;
+
+	for (auto& [OutputName, OutputTexture] : OutputTextures)
+	{
+		IProcessingNode::FHashBuilder HashBuilder;
+		OutputTexture->ComputeGraphHash(HashBuilder);
+		const FGuid OutputHash = HashBuilder.Build();
+
+		if (const TSharedRef<ITextureProcessingNode>* UniqueNode = UniqueNodes.Find(OutputHash))
+			OutputTexture = *UniqueNode;
+		else
+			UniqueNodes.Add(OutputHash, OutputTexture);
+	}
+}
+
 void FTextureSetProcessingGraph::LogError(FText ErrorText)
 {
 	Errors.Add(WorkingModule ? FText::Format(INVTEXT("{0}: {1}"), FText::FromString(WorkingModule->GetInstanceName()), ErrorText) : ErrorText);
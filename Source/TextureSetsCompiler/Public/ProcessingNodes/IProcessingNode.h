@@ -6,6 +6,7 @@
 #include "TextureSetProcessingContext.h"
 #include "TextureSetInfo.h"
 #include "TextureDataTileDesc.h"
+#include "ProcessingNodeTrace.h"
 #include "DerivedDataBuildVersion.h"
 
 class FTextureSetProcessingGraph;
@@ -42,6 +43,30 @@ public:
 	// Should recursively invoke Cache() on dependent nodes.
 	// May execute on a worker thread, so not safe to access UObjects, and should be protected by a mutex.
 	virtual void Cache() = 0;
+
+	// Frees data loaded by Cache(). Every call to Cache() is matched by a call to ReleaseCache(), and nodes may be
+	// shared between several outputs, so data should only be freed once the last user has released it.
+	// Should recursively invoke ReleaseCache() on dependent nodes.
+	// May execute on a worker thread, so not safe to access UObjects, and should be protected by a mutex.
+	virtual void ReleaseCache() {}
+
+protected:
+	// Insights trace state of this node's type, for TEXTURESET_TRACE_NODE_SCOPE and TEXTURESET_TRACE_NODE_WRITE
+	FProcessingNodeTraceType& GetTraceType() const
+	{
+		FProcessingNodeTraceType* Type = TraceType.load(std::memory_order_relaxed);
+
+		if (!Type)
+		{
+			Type = &FProcessingNodeTraceType::Get(GetNodeTypeName());
+			TraceType.store(Type, std::memory_order_relaxed);
+		}
+
+		return *Type;
+	}
+
+private:
+	mutable std::atomic<FProcessingNodeTraceType*> TraceType { nullptr };
 };
 
 // Processing node that computes texture data
@@ -61,9 +86,41 @@ public:
 	// Gets the format of the texture output. Can be called BEFORE prepare()
 	virtual const FTextureSetProcessedTextureDef GetTextureDef() const = 0;
 
+	// Tile shape this node generates most efficiently, used by the compiler to choose the tile size.
+	// Zero components mean no preference. Nodes with inputs should combine their own preference with their inputs'
+	// using CombineTileSizeHints(). Called after the node has been prepared.
+	virtual FIntVector3 GetPreferredTileSize() const { return FIntVector3::ZeroValue; }
+
+	// Reports which channels of the output have the same value for every pixel, and what those values are.
+	// Returns a mask of the constant channels, and writes their values to OutValues. Called after the node has been prepared.
+	// Nodes which transform their input should only report channels which are constant in their input, transformed the
+	// same way WriteChannels() would. Returning 0 is always safe, it just means every channel gets generated per pixel.
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const { return 0; }
+
+	// Combines two tile size hints, so the most restrictive preference of each axis wins
+	static FIntVector3 CombineTileSizeHints(const FIntVector3& A, const FIntVector3& B)
+	{
+		auto Combine = [](int32 X, int32 Y) { return X <= 0 ? Y : (Y <= 0 ? X : FMath::Min(X, Y)); };
+		return FIntVector3(Combine(A.X, B.X), Combine(A.Y, B.Y), Combine(A.Z, B.Z));
+	}
+
 	// Write a channel into the texture data.
 	// May execute on a worker thread, so not safe to access UObjects
 	virtual void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const = 0;
+
+	// Write multiple channels into interleaved texture data. Each channel set in ChannelMask is written at an offset
+	// equal to its channel index from the tile's data index, e.g. channel 2 of a pixel goes to TextureData[DataIndex + 2].
+	// The default implementation calls WriteChannel() once per channel. Nodes which can share work between channels
+	// (reading source data, computing filter weights, etc.) should override this to do it in a single pass.
+	// May execute on a worker thread, so not safe to access UObjects
+	virtual void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const
+	{
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			if (ChannelMask & (1 << Channel))
+				WriteChannel(Channel, Tile.OffsetData(Channel), TextureData);
+		}
+	}
 };
 
 // Processing node that computes a Vec4 parameter
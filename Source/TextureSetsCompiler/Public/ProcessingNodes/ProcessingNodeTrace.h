@@ -0,0 +1,92 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+#include "TextureDataTileDesc.h"
+
+#include <atomic>
+
+// Unreal Insights instrumentation of the processing graph.
+// Every node type gets a CPU scope per stage, named "TextureSet <NodeType>::<Stage>", and two counters of the data it
+// has written, "TextureSets/Nodes/<NodeType>/Pixels" and "TextureSets/Nodes/<NodeType>/Bytes". Scopes of nodes nest
+// the same way the nodes call each other, so the exclusive time of a scope is the cost of that node alone.
+// Scopes only need the cpu channel, and counters the counters channel, e.g. -trace=cpu,counters
+
+enum class EProcessingNodeTraceStage : uint8
+{
+	Prepare,
+	Cache,
+	WriteChannels,
+	Num
+};
+
+// Trace state shared by all nodes with the same type name. Never freed, since trace specs and counters can't be removed.
+class TEXTURESETSCOMPILER_API FProcessingNodeTraceType
+{
+public:
+	// Finds or creates the trace type of a node type name. Thread safe.
+	static FProcessingNodeTraceType& Get(FName NodeTypeName);
+
+	// Begins and ends a CPU scope for a stage of this node type, if the cpu channel is enabled
+	bool BeginScope(EProcessingNodeTraceStage Stage);
+	void EndScope();
+
+	// Adds to the written pixel and byte counters, if the counters channel is enabled
+	void AddWritten(int64 Pixels, int64 Bytes);
+
+private:
+	FProcessingNodeTraceType(FName NodeTypeName);
+
+	const FString Name;
+
+	// Registered lazily, since registering while the channel is disabled would never reach the trace
+	std::atomic<uint32> SpecIds[(int32)EProcessingNodeTraceStage::Num];
+	std::atomic<uint16> PixelsCounterId;
+	std::atomic<uint16> BytesCounterId;
+
+	std::atomic<int64> PixelsWritten;
+	std::atomic<int64> BytesWritten;
+};
+
+// Scope for a stage of a node. Write scopes also count the pixels and channels of the tile written.
+class FProcessingNodeTraceScope
+{
+public:
+	FProcessingNodeTraceScope(FProcessingNodeTraceType& InType, EProcessingNodeTraceStage Stage)
+		: Type(InType)
+		, bScoped(Type.BeginScope(Stage))
+		, Pixels(0)
+		, Bytes(0)
+	{}
+
+	FProcessingNodeTraceScope(FProcessingNodeTraceType& InType, uint8 ChannelMask, const FTextureDataTileDesc& Tile)
+		: Type(InType)
+		, bScoped(Type.BeginScope(EProcessingNodeTraceStage::WriteChannels))
+		, Pixels((int64)Tile.TileSize.X * Tile.TileSize.Y * Tile.TileSize.Z)
+		, Bytes(Pixels * FMath::CountBits(ChannelMask) * sizeof(float))
+	{}
+
+	~FProcessingNodeTraceScope()
+	{
+		if (bScoped)
+			Type.EndScope();
+
+		if (Pixels > 0)
+			Type.AddWritten(Pixels, Bytes);
+	}
+
+private:
+	FProcessingNodeTraceType& Type;
+	const bool bScoped;
+	const int64 Pixels;
+	const int64 Bytes;
+};
+
+// Traces the current stage of a node, from inside one of its member functions
+#define TEXTURESET_TRACE_NODE_SCOPE(Stage) FProcessingNodeTraceScope ANONYMOUS_VARIABLE(NodeTraceScope)(GetTraceType(), EProcessingNodeTraceStage::Stage)
+
+// Traces writing channels of a tile, from inside WriteChannel() or WriteChannels() of a node
+#define TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile) FProcessingNodeTraceScope ANONYMOUS_VARIABLE(NodeTraceScope)(GetTraceType(), ChannelMask, Tile)
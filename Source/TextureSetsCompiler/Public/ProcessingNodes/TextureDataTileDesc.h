@@ -7,7 +7,7 @@
 struct FTextureDataTileDesc
 {
 public:
-	FTextureDataTileDesc(FIntVector3 TextureSize, FIntVector3 TileSize, FIntVector3 TileOffset, FIntVector3 TileDataStride, int32 TileDataOffset)
+	FTextureDataTileDesc(FIntVector3 TextureSize, FIntVector3 TileSize, FIntVector3 TileOffset, FInt64Vector3 TileDataStride, int64 TileDataOffset)
 		: TextureSize(TextureSize)
 		, TileSize(TileSize)
 		, TileOffset(TileOffset)
@@ -22,10 +22,6 @@ public:
 		check(TileOffset.Y + TileSize.Y <= TextureSize.Y);
 		check(TileOffset.Z + TileSize.Z <= TextureSize.Z);
 
-		// Check if we might get out of range because our texture is too large
-		check(((int64)TextureSize.X * (int64)TextureSize.Y * (int64)TextureSize.Z) < (int64)MAX_int32);
-		check(((int64)TileDataStride.Z * (int64)TextureSize.Z + 1) < (int64)MAX_int32);
-
 		TileDataStepSize.X = TileDataStride.X;
 		TileDataStepSize.Y = TileDataStride.Y - TileDataStepSize.X * TileSize.X;
 		TileDataStepSize.Z = TileDataStride.Z - TileDataStride.Y * TileSize.Y - TileDataStepSize.Y;
@@ -35,16 +31,18 @@ public:
 	const FIntVector3 TextureSize; // Size of the entire texture, in pixels
 	const FIntVector3 TileSize; // Size of the tile, in pixels
 	const FIntVector3 TileOffset; // Offset of the tile within the texture, in pixels
-	const int32 TileDataOffset; // Index into the data where this tile starts
-	const FIntVector3 TileDataStride; // Stride in each direction of the tile data
+	const int64 TileDataOffset; // Index into the data where this tile starts
+	const FInt64Vector3 TileDataStride; // Stride in each direction of the tile data
 
 	// Computed
-	FIntVector3 TileDataStepSize; // Step size when iterating through the tile data in each dimension
+	// Data indices, strides and steps are 64 bit, since a 16k RGBA texture or a large texture array has more elements
+	// than fit in an int32. Pixel coordinates and sizes always fit, so they stay 32 bit.
+	FInt64Vector3 TileDataStepSize; // Step size when iterating through the tile data in each dimension
 	
 	// Helper function to compute the data srides based on element stride, and the dimensions of the full image buffer's data
-	inline static FIntVector3 ComputeDataStrides(int32 ElementStride, FIntVector3 DataPixelDimension)
+	inline static FInt64Vector3 ComputeDataStrides(int32 ElementStride, FIntVector3 DataPixelDimension)
 	{
-		FIntVector3 DataStrides;
+		FInt64Vector3 DataStrides;
 		DataStrides.X = ElementStride;
 		DataStrides.Y = DataPixelDimension.X * DataStrides.X;
 		DataStrides.Z = DataPixelDimension.Y * DataStrides.Y;
@@ -52,13 +50,19 @@ public:
 	}
 
 	// Helper function to compute data offset.
-	inline static int64 ComputeDataOffset(FIntVector3 TileOffset, FIntVector3 DataStrides)
+	inline static int64 ComputeDataOffset(FIntVector3 TileOffset, FInt64Vector3 DataStrides)
 	{
 		return (TileOffset.X * DataStrides.X) + (TileOffset.Y * DataStrides.Y) + (TileOffset.Z * DataStrides.Z);
 	}
 
+	// Returns a copy of this tile with the data offset shifted, e.g. to address another channel of interleaved data
+	inline FTextureDataTileDesc OffsetData(int64 Offset) const
+	{
+		return FTextureDataTileDesc(TextureSize, TileSize, TileOffset, TileDataStride, TileDataOffset + Offset);
+	}
+
 	// Takes a tile coordinate and produces an index into the tile data
-	inline uint32 TileCoordToDataIndex(const FIntVector& Coord) const
+	inline int64 TileCoordToDataIndex(const FIntVector& Coord) const
 	{
 		return TileDataOffset + (Coord.X * TileDataStride.X) + (Coord.Y * TileDataStride.Y) + (Coord.Z * TileDataStride.Z);
 	}
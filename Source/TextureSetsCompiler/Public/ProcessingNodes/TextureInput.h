@@ -21,17 +21,29 @@ public:
 	virtual void ComputeDataHash(const FTextureSetProcessingContext& Context, FHashBuilder& HashBuilder) const override { check(LastNode); LastNode->ComputeDataHash(Context, HashBuilder); }
 	virtual void Prepare(const FTextureSetProcessingContext& Context) override { check(LastNode); LastNode->Prepare(Context); }
 	virtual void Cache() override { check(LastNode); LastNode->Cache(); }
+	virtual void ReleaseCache() override { check(LastNode); LastNode->ReleaseCache(); }
 
 	virtual FTextureDimension GetTextureDimension() const override { check(LastNode); return LastNode->GetTextureDimension(); }
 	virtual const FTextureSetProcessedTextureDef GetTextureDef() const override { check(LastNode); return LastNode->GetTextureDef(); }
+	virtual FIntVector3 GetPreferredTileSize() const override { check(LastNode); return LastNode->GetPreferredTileSize(); }
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override { check(LastNode); return LastNode->GetConstantChannels(OutValues); }
 
 	virtual void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override { LastNode->WriteChannel(Channel, Tile, TextureData); }
+	virtual void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override { LastNode->WriteChannels(ChannelMask, Tile, TextureData); }
 
 	void AddOperator(CreateOperatorFunc Operator) { CreateOperatorFuncs.Add(Operator); }
 
+	const TSharedRef<FTextureRead>& GetTextureRead() const { return TextureRead; }
+
 private:
 	void InstantiateOperators(const FTextureSetProcessingGraph& Graph);
 
+	// Replaces the read and re-instantiates the operators on top of it. Used to share reads of identical source data.
+	void SetTextureRead(TSharedRef<FTextureRead> NewTextureRead, const FTextureSetProcessingGraph& Graph);
+
+	// Uses the operator chain of another input which computes the same result
+	void ShareOperators(const FTextureInput& Other);
+
 	TArray<CreateOperatorFunc> CreateOperatorFuncs;
 	TArray<TSharedRef<class ITextureProcessingNode>> Operators;
 	TSharedPtr<ITextureProcessingNode> LastNode;
@@ -19,11 +19,13 @@ public:
 	}
 
 	virtual void ComputeDataHash(const FTextureSetProcessingContext& Context, FHashBuilder& HashBuilder) const override { SourceImage->ComputeDataHash(Context, HashBuilder); }
-	virtual void Prepare(const FTextureSetProcessingContext& Context) override { SourceImage->Prepare(Context); }
-	virtual void Cache() override { SourceImage->Cache(); }
+	virtual void Prepare(const FTextureSetProcessingContext& Context) override { TEXTURESET_TRACE_NODE_SCOPE(Prepare); SourceImage->Prepare(Context); }
+	virtual void Cache() override { TEXTURESET_TRACE_NODE_SCOPE(Cache); SourceImage->Cache(); }
+	virtual void ReleaseCache() override { SourceImage->ReleaseCache(); }
 
 	virtual FTextureDimension GetTextureDimension() const override { return SourceImage->GetTextureDimension(); }
 	virtual const FTextureSetProcessedTextureDef GetTextureDef() const override { return SourceImage->GetTextureDef(); }
+	virtual FIntVector3 GetPreferredTileSize() const override { return SourceImage->GetPreferredTileSize(); }
 
 	const TSharedRef<ITextureProcessingNode> SourceImage;
 };
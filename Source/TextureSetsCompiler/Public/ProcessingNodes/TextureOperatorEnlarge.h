@@ -28,6 +28,15 @@ public:
 		return {TargetWidth, TargetHeight, SourceDimension.Slices};
 	}
 
+	// Each output pixel gathers a neighbourhood of source pixels, so small tiles keep both the source and output tile in cache
+	virtual FIntVector3 GetPreferredTileSize() const override
+	{
+		return CombineTileSizeHints(FIntVector3(64, 64, 1), SourceImage->GetPreferredTileSize());
+	}
+
+	// Enlarging a constant doesn't change it
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override { return SourceImage->GetConstantChannels(OutValues); }
+
 	inline FIntVector TransformToSource(const FIntVector& Position) const
 	{
 		const FTextureDimension SourceDimension = SourceImage->GetTextureDimension();
@@ -43,10 +52,11 @@ public:
 
 	static inline float CalulateInterp(int32 TargetCoord, int32 TargetSize, int32 SourceSize)
 	{
-		return float((TargetCoord * SourceSize) % TargetSize) / float(TargetSize);
+		return float(((int64)TargetCoord * SourceSize) % TargetSize) / float(TargetSize);
 	}
 
 	virtual void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override;
+	virtual void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override;
 
 private:
 	const int TargetWidth;
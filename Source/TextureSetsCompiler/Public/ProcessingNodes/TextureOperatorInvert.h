@@ -13,13 +13,46 @@ public:
 
 	virtual FName GetNodeTypeName() const  { return "Invert"; }
 
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override
+	{
+		const uint8 ConstantMask = SourceImage->GetConstantChannels(OutValues);
+
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			if (ConstantMask & (1 << Channel))
+				OutValues[Channel] = 1.0f - OutValues[Channel];
+		}
+
+		return ConstantMask;
+	}
+
 	virtual void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override
 	{
-		SourceImage->WriteChannel(Channel, TextureData);
+		TEXTURESET_TRACE_NODE_WRITE(1 << Channel, Tile);
+
+		SourceImage->WriteChannel(Channel, Tile, TextureData);
 
-		Channel.ForEachPixel([TextureData](FTextureDataTileDesc::ForEachPixelContext& Context)
+		Tile.ForEachPixel([TextureData](FTextureDataTileDesc::ForEachPixelContext& Context)
 		{
 			TextureData[Context.DataIndex] = 1.0f - TextureData[Context.DataIndex];
 		});
 	}
+
+	virtual void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override
+	{
+		TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile);
+
+		SourceImage->WriteChannels(ChannelMask, Tile, TextureData);
+
+		for (int32 Channel = 0; Channel < 4; Channel++)
+		{
+			if (ChannelMask & (1 << Channel))
+			{
+				Tile.ForEachPixel([TextureData, Channel](FTextureDataTileDesc::ForEachPixelContext& Context)
+				{
+					TextureData[Context.DataIndex + Channel] = 1.0f - TextureData[Context.DataIndex + Channel];
+				});
+			}
+		}
+	}
 };
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#pragma once
+
+#include "TextureOperator.h"
+
+#include <atomic>
+
+// Memory bounded cache of generated tiles, shared by all the tile cache operators of a compilation.
+// Entries are keyed by (node, channel, tile rect) and evicted least recently used first once over budget.
+class FTextureTileCache
+{
+public:
+	FTextureTileCache(int64 MaxBytes)
+		: MaxBytes(MaxBytes)
+		, UsedBytes(0)
+		, UseCounter(0)
+		, Hits(0)
+		, Misses(0)
+	{}
+
+	struct FKey
+	{
+		const void* Node;
+		int32 Channel;
+		FIntVector3 TileOffset;
+		FIntVector3 TileSize;
+
+		bool operator==(const FKey& Other) const
+		{
+			return Node == Other.Node && Channel == Other.Channel && TileOffset == Other.TileOffset && TileSize == Other.TileSize;
+		}
+
+		friend uint32 GetTypeHash(const FKey& Key)
+		{
+			uint32 Hash = GetTypeHash(Key.Node);
+			Hash = HashCombine(Hash, GetTypeHash(Key.Channel));
+			Hash = HashCombine(Hash, GetTypeHash(Key.TileOffset));
+			return HashCombine(Hash, GetTypeHash(Key.TileSize));
+		}
+	};
+
+	// Copies a cached channel into the tile, returns false if it's not in the cache
+	bool Read(const FKey& Key, const FTextureDataTileDesc& Tile, float* TextureData);
+
+	// Copies a channel out of the tile into the cache, evicting old entries if needed
+	void Write(const FKey& Key, const FTextureDataTileDesc& Tile, const float* TextureData);
+
+	// Removes all entries of a node
+	void Remove(const void* Node);
+
+	int64 GetHits() const { return Hits; }
+	int64 GetMisses() const { return Misses; }
+	int64 GetUsedBytes() const { FScopeLock Lock(&CS); return UsedBytes; }
+
+private:
+	struct FEntry
+	{
+		TArray64<float> Data;
+		uint64 LastUse;
+	};
+
+	void Evict(int64 TargetBytes);
+
+	const int64 MaxBytes;
+
+	mutable FCriticalSection CS;
+	TMap<FKey, FEntry> Entries;
+	int64 UsedBytes;
+	uint64 UseCounter;
+
+	std::atomic<int64> Hits;
+	std::atomic<int64> Misses;
+};
+
+// Caches the tiles generated by its source, so source work shared between multiple channels, packed textures, or
+// passes over the same tiles is only computed once.
+class FTextureOperatorTileCache : public FTextureOperator
+{
+public:
+	FTextureOperatorTileCache(TSharedRef<ITextureProcessingNode> I, TSharedRef<FTextureTileCache> TileCache) : FTextureOperator(I)
+		, TileCache(TileCache)
+		, CacheRefCount(0)
+	{}
+
+	virtual FName GetNodeTypeName() const  { return "TileCache"; }
+
+	virtual void Cache() override;
+	virtual void ReleaseCache() override;
+
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override { return SourceImage->GetConstantChannels(OutValues); }
+
+	virtual void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override;
+	virtual void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override;
+
+private:
+	const TSharedRef<FTextureTileCache> TileCache;
+
+	FCriticalSection CacheCS;
+	int32 CacheRefCount;
+};
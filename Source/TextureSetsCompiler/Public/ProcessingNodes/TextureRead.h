@@ -25,15 +25,28 @@ public:
 	virtual void ComputeDataHash(const FTextureSetProcessingContext& Context, FHashBuilder& HashBuilder) const override;
 	virtual void Prepare(const FTextureSetProcessingContext& Context) override;
 	virtual void Cache() override;
+	virtual void ReleaseCache() override;
 
 	virtual FTextureDimension GetTextureDimension() const override { check(bPrepared); return { Width, Height, Slices }; }
 	virtual const FTextureSetProcessedTextureDef GetTextureDef() const override { return SourceDefinition; }
+	// Reading is a straight copy of contiguous source rows, so whole rows are the most efficient
+	virtual FIntVector3 GetPreferredTileSize() const override { check(bPrepared); return FIntVector3(Width, 0, 1); }
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override;
 
 	virtual void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override;
+	virtual void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override;
 
 	void AddOperator(CreateOperatorFunc Operator) { CreateOperatorFuncs.Add(Operator); }
 
+	const FTextureSetSourceTextureDef& GetSourceDefinition() const { return SourceDefinition; }
+
+	// Size in bytes of the source data loaded by Cache(), 0 if there is no source. Called after the node has been prepared.
+	int64 GetSourceMipSize() const;
+
 private:
+	// Converts the loaded source mip to linear ConvertedFormat, box filtering it down by DownsampleFactor
+	FSharedBuffer ConvertSource(const FSharedBuffer& SourceMip) const;
+
 	FName SourceName;
 	FTextureSetSourceTextureDef SourceDefinition;
 
@@ -51,5 +64,20 @@ private:
 	int Slices;
 	ETextureSourceFormat TextureSourceFormat;
 	EGammaSpace TextureSourceGamma;
-	FSharedBuffer TextureSourceMip0;
+	FSharedBuffer TextureSourceData;
+	FString SourceDataId; // Key of the source in FTextureSourceCache, empty if it can't be shared
+	bool bPinnedSourceMip; // TextureSourceData is a mip pinned in FTextureSourceCache
+
+	// Format of TextureSourceData. Converted data is linear, with ValidChannels per pixel in the order of the source's
+	// channels, and is half float if the source is, or float otherwise, so it reads back exactly like the source.
+	ETextureSourceFormat ReadFormat;
+	ETextureSourceFormat ConvertedFormat;
+
+	// Reduced resolution reads, for previews. Sources are read from ReadMip when they have it, and otherwise box
+	// filtered from their largest mip by DownsampleFactor.
+	int32 ReadMip;
+	int32 DownsampleFactor;
+
+	FCriticalSection CacheCS;
+	int32 CacheRefCount;
 };
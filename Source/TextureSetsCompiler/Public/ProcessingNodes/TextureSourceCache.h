@@ -0,0 +1,85 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Memory/SharedBuffer.h"
+
+#include <atomic>
+
+// Process wide cache of decoded source texture mips, shared by every compilation, so texture sets that reference the
+// same source only decompress its bulk data once. Entries are keyed by the source's data ID and mip index, and are
+// pinned while any texture read uses them. Unpinned entries are kept up to ts.SourceDataCacheSizeMB and evicted least
+// recently used first.
+class TEXTURESETSCOMPILER_API FTextureSourceCache
+{
+public:
+	static FTextureSourceCache& Get();
+
+	struct FKey
+	{
+		FString SourceDataId;
+		int32 MipIndex;
+
+		bool operator==(const FKey& Other) const { return MipIndex == Other.MipIndex && SourceDataId == Other.SourceDataId; }
+		friend uint32 GetTypeHash(const FKey& Key) { return HashCombine(GetTypeHash(Key.SourceDataId), GetTypeHash(Key.MipIndex)); }
+	};
+
+	// Returns the cached mip and pins it, or loads it if it isn't cached. Concurrent acquires of the same mip wait on
+	// a single load. Every acquire needs a matching Release(). Entries are budgeted by the size of the loaded buffer, so
+	// Load must not return a view that keeps a larger allocation alive.
+	FSharedBuffer Acquire(const FKey& Key, TFunctionRef<FSharedBuffer()> Load);
+	void Release(const FKey& Key);
+
+	int64 GetHits() const { return Hits; }
+	int64 GetMisses() const { return Misses; }
+	int64 GetUsedBytes() const { FScopeLock Lock(&CS); return UsedBytes; }
+
+	// Opt-in disk cache of sources in the layout texture reads consume (see ts.SourceDiskCache). Files are memory
+	// mapped where the platform supports it, so reads come straight from the page cache. The directory is scanned on first
+	// use, deleting files of older versions, and trimmed to ts.SourceDiskCache.SizeMB, least recently used first.
+	static bool IsDiskCacheEnabled();
+
+	// Maps the source stored under the key, or returns null if there is none of the expected size
+	FSharedBuffer FindOnDisk(const FString& Key, uint64 ExpectedSize);
+
+	// Writes source data to the disk cache, and returns the mapped file, or the data itself if it couldn't be mapped
+	FSharedBuffer StoreOnDisk(const FString& Key, const FSharedBuffer& Data);
+
+	// Logs the hit rate and memory use of the cache
+	void LogStats() const;
+
+private:
+	struct FEntry
+	{
+		FCriticalSection LoadCS;
+		FSharedBuffer Data;
+		int32 Users = 0;
+		uint64 LastUse = 0;
+	};
+
+	// Must be called with the lock held
+	void Evict(int64 MaxBytes);
+
+	// Scans the disk cache directory the first time it's used
+	void ScanDiskCache();
+	// Rescans the disk cache directory, deleting stale files and trimming it to its size limit. Must be called with DiskCacheCS held.
+	void TrimDiskCache();
+
+	mutable FCriticalSection CS;
+	TMap<FKey, TSharedRef<FEntry>> Entries;
+	int64 UsedBytes = 0;
+	uint64 UseCounter = 0;
+
+	std::atomic<int64> Hits { 0 };
+	std::atomic<int64> Misses { 0 };
+	std::atomic<int64> Evictions { 0 };
+
+	std::atomic<int64> DiskCacheHits { 0 };
+	std::atomic<int64> DiskCacheMisses { 0 };
+	std::atomic<int64> DiskCacheEvictions { 0 };
+
+	mutable FCriticalSection DiskCacheCS;
+	bool bDiskCacheScanned = false;
+	int64 DiskCacheBytes = 0; // Size of the disk cache directory, as of the last scan plus stores since
+};
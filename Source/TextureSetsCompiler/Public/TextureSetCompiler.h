@@ -3,16 +3,20 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "DerivedDataPluginInterface.h"
 #include "TextureSetDerivedData.h"
 #include "TextureSetInfo.h"
 #include "TextureSetModule.h"
 #include "TextureSetProcessingGraph.h"
 #include "TextureSetProcessingContext.h"
 
+#include <atomic>
+
 class UTextureSet;
 class FTextureSetCompiler;
 class ITextureProcessingNode;
+class FTextureTileCache;
+
+namespace UE::DerivedData { class FRequestOwner; }
 
 struct FTextureSetCompilerArgs
 {
@@ -24,13 +28,20 @@ struct FTextureSetCompilerArgs
 	FString DebugContext;
 	FString UserKey;
 	TObjectPtr<UObject> OuterObject;
-	FIntVector3 TileSize = FIntVector3(128,128,1);
+	FIntVector3 TileSize = FIntVector3::ZeroValue; // Zero to choose the tile size automatically from the graph and ts.TileCacheBudgetKB
+	int32 PreviewMaxSize = 0; // Non-zero to compile a low resolution preview, reading sources at no more than this size
+};
+
+// Generated data of a packed texture found in the DDC ahead of generating it (see FTextureSetCompiler::FetchGenerationCacheData)
+struct FTextureSetGenerationCacheData
+{
+	bool bFetched = false; // Lookups have been made, so GenerateTextureSource doesn't repeat them
+	TStaticArray<FSharedBuffer, 4> Channels; // Decompressed channel cache entries that were found, per packed channel (ts.ChannelCache)
+	FSharedBuffer Source; // Decompressed source cache record, if found (ts.SourceCache)
 };
 
 class TEXTURESETSCOMPILER_API FTextureSetCompiler
 {
-	friend class TextureSetDerivedTextureDataPlugin;
-	friend class TextureSetDerivedParameterDataPlugin;
 	friend class FTextureSetCompilerTaskWorker;
 public:
 
@@ -47,33 +58,93 @@ public:
 
 	void ConfigureTexture(FDerivedTexture& DerivedTexture, int Index) const;
 	void InitializeTextureSource(FDerivedTexture& DerivedTexture, int Index) const;
-	void GenerateTextureSource(FDerivedTexture& DerivedTexture, int Index) const;
+	// CacheData is the result of FetchGenerationCacheData for this texture, if already fetched. Its buffers are released as they're used.
+	void GenerateTextureSource(FDerivedTexture& DerivedTexture, int Index, FTextureSetGenerationCacheData* CacheData = nullptr) const;
 	void FreeTextureSource(FDerivedTexture& DerivedTexture, int Index) const;
 
 	FDerivedParameterData BuildParameterData(FName Name) const;
 
+	// True if generating a texture looks up previously generated data in the DDC, which can be fetched ahead of time
+	bool UsesGenerationCaches() const;
+
+	// Looks up the previously generated data of packed textures in a single batched DDC request, so it can be passed to
+	// GenerateTextureSource. OutData is indexed like Indices. Returns early if the compile is cancelled.
+	void FetchGenerationCacheData(TConstArrayView<int32> Indices, TArrayView<FTextureSetGenerationCacheData> OutData) const;
+
 	FGuid GetTextureDataId(int Index) const;
+
+	// Format of the generated texture source, chosen to be the smallest format that preserves the precision of the packed texture
+	ETextureSourceFormat GetTextureSourceFormat(int Index) const;
+
+	// Size of the generated texture source, the largest of the processed textures packed into it
+	FIntVector3 GetTextureSourceSize(int Index) const;
+
+	// Estimate in bytes of the most memory this compilation will use at once, from the size and format of its sources,
+	// generated textures and graph intermediates. Requires the compiler to be prepared.
+	int64 EstimatePeakMemory() const;
+
+	// Cheaper estimate of the same, from the dimensions and formats of the source textures and the packing info alone, so
+	// queued compilations can be admitted without preparing a compiler. Assumes packed textures are as big as their largest source.
+	static int64 EstimatePeakMemory(const FTextureSetCompilerArgs& Args);
 	FGuid GetParameterDataId(FName Name) const;
 
 	const TSharedRef<const FTextureSetCompilerArgs> Args;
 
 	TArray<FName> GetAllParameterNames() const;
 
+	// Asks work in progress to stop as soon as possible. Generation checks between tiles, and leaves a cancelled texture
+	// without generated source so nothing partial is ever cached. Outstanding DDC requests waited on with WaitForRequests()
+	// are cancelled too. Thread safe, and can't be undone.
+	void Cancel();
+	bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+	// Blocks until the requests of the owner complete, or cancels them if the compile is (or gets) cancelled meanwhile
+	void WaitForRequests(UE::DerivedData::FRequestOwner& Owner) const;
+
+	// Previews have their own data IDs, and are never stored in or fetched from the DDC
+	bool IsPreview() const { return Args->PreviewMaxSize > 0; }
+
 private:
 	FTextureSetProcessingContext Context;
 	TSharedPtr<FTextureSetProcessingGraph> GraphInstance;
 
 	bool bPrepared;
+	const bool bFastGammaEncode;
+	std::atomic<bool> bCancelled { false };
+
+	// Owners currently being waited on by WaitForRequests(), so Cancel() can cancel them
+	mutable FCriticalSection RequestOwnersCS;
+	mutable TArray<UE::DerivedData::FRequestOwner*> RequestOwners;
+
+	// Optional cache of generated tiles, shared by every output texture of this compilation
+	TSharedPtr<FTextureTileCache> TileCache;
+	TMap<FName, TSharedRef<ITextureProcessingNode>> TileCachedOutputTextures;
 
 	mutable TArray<FGuid> CachedDerivedTextureIds;
 	mutable TMap<FName, FGuid> CachedParameterIds;
 
+	// Graph and data hash of each output texture, computed in Prepare() since data hashes can only be computed on the game thread
+	TMap<FName, FGuid> OutputTextureDataIds;
+
 	FGuid ComputeTextureDataId(int Index) const;
+
+	// Restores a previously generated source and its derived data from a source cache record (see ts.SourceCache)
+	bool RestoreTextureSource(FDerivedTexture& DerivedTexture, int Index, const FSharedBuffer& Record) const;
+
+	// Key for the channel cache, which covers everything that affects the data generated for a single packed channel
+	FGuid ComputeChannelDataId(int Index, int Channel, const FIntVector3& TextureSize) const;
+
+	// Mask of packed channels which are looked up in, and stored to, the channel cache
+	uint8 GetChannelCacheMask(int Index) const;
+
+	// Mask of packed texture channels which have the same value for every pixel (including channels with no output),
+	// and their values before encoding.
+	uint8 GetConstantChannels(int Index, FVector4f& OutValues) const;
 	FGuid ComputeParameterDataId(const TSharedRef<IParameterProcessingNode> Parameter) const;
 
-	static inline int GetPixelIndex(int X, int Y, int Z, int Channel, int Width, int Height, int PixelStride)
+	static inline int64 GetPixelIndex(int X, int Y, int Z, int Channel, int Width, int Height, int PixelStride)
 	{
-		return ((Z * Width * Height) + (Y * Width) + X) * PixelStride + Channel;
+		return (((int64)Z * Width * Height) + ((int64)Y * Width) + X) * PixelStride + Channel;
 	}
 
 };
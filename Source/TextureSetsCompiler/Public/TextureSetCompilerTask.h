@@ -37,10 +37,24 @@ public:
 	bool TryFinalize();
 	void Finalize();
 
-	void SetPriority(EQueuedWorkPriority InPriority) { AsyncTask->SetPriority(InPriority); }
+	void SetPriority(EQueuedWorkPriority InPriority) { Priority = InPriority; AsyncTask->SetPriority(InPriority); }
+	EQueuedWorkPriority GetPriority() const { return Priority; }
 	bool Cancel() { return AsyncTask->Cancel(); }
 
+	// Asks work that has already started to stop early, for when Cancel() fails. The task has to be kept alive until
+	// IsDone(), and never produces usable derived data.
+	void RequestCancel();
+	bool IsDone() { return !AsyncTask.IsValid() || AsyncTask->IsDone(); }
+	// Blocks until IsDone(), without finalizing
+	void WaitUntilDone() { if (AsyncTask.IsValid()) AsyncTask->EnsureCompletion(true, true); }
+
 	TSharedRef<FTextureSetCompiler> GetCompiler() const { return Compiler; }
+
+	// Estimated peak memory of the compile work, published once the task has started (see FTextureSetCompiler::EstimatePeakMemory)
+	int64 GetEstimatedPeakMemory() const { return EstimatedPeakMemory; }
+
+	// True once the compile work is done and its memory freed, while the engine may still be building the textures
+	bool IsWorkDone() const { return AsyncTask.IsValid() && AsyncTask->IsWorkDone(); }
 	TObjectPtr<UTextureSetDerivedData> GetDerivedData() { check(bHasFinalized); return DerivedData.Get(); }
 
 private:
@@ -52,6 +66,8 @@ private:
 	bool bHasBeganTextureCache;
 	bool bHasAddedSourceProviders;
 	bool bHasFinalized;
+	int64 EstimatedPeakMemory;
+	EQueuedWorkPriority Priority;
 
 	TUniquePtr<FAsyncTask<FTextureSetCompilerTaskWorker>> AsyncTask;
 };
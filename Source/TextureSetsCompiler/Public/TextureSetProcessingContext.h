@@ -11,4 +11,5 @@ struct FTextureSetProcessingContext
 	TMap<FName, FTextureSetSourceTextureReference> SourceTextures;
 	FTextureSetAssetParamsCollection AssetParams;
 	TSharedPtr<class FTextureSetProcessingGraph> Graph;
+	int32 MaxSourceSize = 0; // Largest width or height to read source textures at, zero for full resolution
 };
@@ -10,6 +10,7 @@ class FTextureInput;
 struct FTextureSetSourceTextureDef;
 class ITextureProcessingNode;
 class IParameterProcessingNode;
+struct FTextureSetProcessingContext;
 
 #define CreateOperatorFunc TFunction<TSharedRef<ITextureProcessingNode>(TSharedRef<ITextureProcessingNode>)>
 
@@ -35,10 +36,17 @@ public:
 	void AddDefaultInputOperator(CreateOperatorFunc Func) { DefaultInputOperators.Add(Func); }
 	const TArray<CreateOperatorFunc>& GetDefaultInputOperators() const { return DefaultInputOperators; }
 
+	// Makes inputs which read identical source data share the same nodes, and then deduplicates the outputs again.
+	// Called by the compiler once the context is known. Changes the graph hash of affected outputs.
+	void DeduplicateInputs(const FTextureSetProcessingContext& Context);
+
 	void LogError(FText ErrorText);
 	const TArray<FText>& GetErrors() const { return Errors; }
 
 private:
+	// Makes output textures with identical graph hashes share a single node, so each distinct computation runs once
+	void DeduplicateOutputTextures();
+
 	TMap<FName, TSharedRef<FTextureInput>> InputTextures;
 	TArray<CreateOperatorFunc> DefaultInputOperators;
 	TMap<FName, TSharedRef<ITextureProcessingNode>> OutputTextures;
@@ -697,7 +697,7 @@ UMaterialExpression* FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode(in
 	CustomExp->IncludeFilePaths.Add("/Engine/Private/Common.ush");
 	CustomExp->Code = "";
 
-	FString SampleType = FString::Format(TEXT("MaterialFloat{0} Sample = "), {(TextureInfo.ChannelCount > 1) ? FString::FromInt(TextureInfo.ChannelCount) : ""});
+	const FString SampleType = FString::Format(TEXT("MaterialFloat{0}"), {(TextureInfo.ChannelCount > 1) ? FString::FromInt(TextureInfo.ChannelCount) : ""});
 
 	if (bVirtualTextureStreaming)
 	{
@@ -718,8 +718,7 @@ UMaterialExpression* FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode(in
 		constexpr uint32 RGBAOutputIndex = 5;
 		Connect(FGraphBuilderOutputPin(SampleExpression, RGBAOutputIndex), CustomExp, 0);
 
-		// Set the correct size of float for how many channels we have
- 		CustomExp->Code += FString::Format(TEXT("{0} InSample."), {SampleType});
+		CustomExp->Code += TEXT("Sample = InSample.");
 	}
 	else
 	{
@@ -733,8 +732,7 @@ UMaterialExpression* FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode(in
 		if (!bIsArray)
 			CustomExp->Code += "FloatDeriv2 UV = {Texcoord.xy, DDX, DDY};\n";
 
-		// Set the correct size of float for how many channels we have
-		CustomExp->Code += FString::Format(TEXT("{0}"), {SampleType});
+		CustomExp->Code += TEXT("Sample = ");
 
 		// Do the appropriate sample
 		if (bIsArray)
@@ -754,6 +752,7 @@ UMaterialExpression* FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode(in
 
 	uint32 RangeCompressMulInput = 0;
 	uint32 RangeCompressAddInput = 0;
+	FString OutputCode;
 
 	// Process each channel
 	for (int c = 0; c < TextureInfo.ChannelCount; c++)
@@ -781,9 +780,32 @@ UMaterialExpression* FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode(in
 
 		// Add an output pin for this channel
 		CustomExp->AdditionalOutputs.Add(FCustomOutput({FName(ChannelSuffixUpper[c]), ECustomMaterialOutputType::CMOT_Float1}));
-		CustomExp->Code += FString::Format(TEXT("{1} = Sample.{0};\n"), FormatArgs);
+		OutputCode += FString::Format(TEXT("{1} = Sample.{0};\n"), FormatArgs);
 	}
 
+	// When the compiler finds every channel of this texture constant, it sets a flag and the decoded values as parameters.
+	// Branching on the flag lets the same material serve both cases, and skip the sample and decode for constant textures.
+	const uint32 ConstantEnabledInput = CustomExp->Inputs.Num();
+	CustomExp->Inputs.Add({"ConstantEnabled"});
+	const uint32 ConstantValueInput = CustomExp->Inputs.Num();
+	CustomExp->Inputs.Add({"ConstantValue"});
+
+	FString ConstantSwizzle;
+	for (int c = 0; c < TextureInfo.ChannelCount; c++)
+		ConstantSwizzle += ChannelSuffixLower[c];
+
+	CustomExp->Code = SampleType + " Sample;\n"
+		+ "BRANCH\n"
+		+ "if (ConstantEnabled.x > 0)\n"
+		+ "{\n"
+		+ "Sample = ConstantValue." + ConstantSwizzle + ";\n"
+		+ "}\n"
+		+ "else\n"
+		+ "{\n"
+		+ CustomExp->Code
+		+ "}\n"
+		+ OutputCode;
+
 	// Return the correct output type
 	static const ECustomMaterialOutputType OutputTypes[4] {CMOT_Float1, CMOT_Float2, CMOT_Float3, CMOT_Float4};
 	CustomExp->OutputType = OutputTypes[TextureInfo.ChannelCount - 1];
@@ -807,6 +829,15 @@ UMaterialExpression* FTextureSetSampleFunctionBuilder::BuildTextureDecodeNode(in
 		Connect(Add, (UMaterialExpression*)CustomExp, RangeCompressAddInput);
 	}
 
+	if (!ConstantParameters.Contains(TextureInfo.ConstantEnabledName))
+		MakeConstantParameter(TextureInfo.ConstantEnabledName, FVector4f::Zero());
+
+	if (!ConstantParameters.Contains(TextureInfo.ConstantValueName))
+		MakeConstantParameter(TextureInfo.ConstantValueName, FVector4f::Zero());
+
+	Connect(FGraphBuilderOutputPin(ConstantParameters.FindChecked(TextureInfo.ConstantEnabledName), 0), (UMaterialExpression*)CustomExp, ConstantEnabledInput);
+	Connect(FGraphBuilderOutputPin(ConstantParameters.FindChecked(TextureInfo.ConstantValueName), 0), (UMaterialExpression*)CustomExp, ConstantValueInput);
+
 	CustomExp->Description = FString::Format(TEXT("{0}_Decode"), {TextureSetsHelpers::MakeTextureParameterName(Args.ParameterName, Index).ToString()});
 
 	return CustomExp;
@@ -71,6 +71,9 @@ public:
 
 	virtual FTextureDimension GetTextureDimension() const override { return { SubImageWidth, SubImageHeight, Slices}; }
 
+	// Rearranging frames doesn't change constant channels
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override { return SourceImage->GetConstantChannels(OutValues); }
+
 	FIntVector TransformToSource(FIntVector Position) const
 	{
 		const int SubImageIndex = Position.Z % FramesPerImage;
@@ -84,10 +87,17 @@ public:
 
 	void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override
 	{
+		WriteChannels(1 << Channel, Tile.OffsetData(-Channel), TextureData);
+	}
+
+	void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override
+	{
+		TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile);
+
 		if (FramesPerImage == 1)
 		{
 			// Can early out without remapping the frames
-			SourceImage->WriteChannel(Channel, Tile, TextureData);
+			SourceImage->WriteChannels(ChannelMask, Tile, TextureData);
 			return;
 		}
 		
@@ -129,7 +139,7 @@ public:
 						Tile.TileCoordToDataIndex(FIntVector3(0, 0, DestSlice - Tile.TileOffset.Z))
 					);
 					
-					SourceImage->WriteChannel(Channel, SourceTile, TextureData);
+					SourceImage->WriteChannels(ChannelMask, SourceTile, TextureData);
 				}
 			}
 		}
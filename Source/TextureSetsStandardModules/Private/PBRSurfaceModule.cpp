@@ -37,8 +37,20 @@ public:
 		HashBuilder << (FlipbookAssetParams->bFlipNormalGreen);
 	}
 
+	virtual uint8 GetConstantChannels(FVector4f& OutValues) const override
+	{
+		const uint8 ConstantMask = SourceImage->GetConstantChannels(OutValues);
+
+		if ((ConstantMask & (1 << 1)) && bFlipGreen)
+			OutValues[1] = 1.0f - OutValues[1];
+
+		return ConstantMask;
+	}
+
 	void WriteChannel(int32 Channel, const FTextureDataTileDesc& Tile, float* TextureData) const override
 	{
+		TEXTURESET_TRACE_NODE_WRITE(1 << Channel, Tile);
+
 		SourceImage->WriteChannel(Channel, Tile, TextureData);
 
 		if (Channel == 1 && bFlipGreen)
@@ -50,6 +62,21 @@ public:
 		}
 	}
 
+	void WriteChannels(uint8 ChannelMask, const FTextureDataTileDesc& Tile, float* TextureData) const override
+	{
+		TEXTURESET_TRACE_NODE_WRITE(ChannelMask, Tile);
+
+		SourceImage->WriteChannels(ChannelMask, Tile, TextureData);
+
+		if ((ChannelMask & (1 << 1)) && bFlipGreen)
+		{
+			Tile.ForEachPixel([TextureData](FTextureDataTileDesc::ForEachPixelContext& Context)
+			{
+				TextureData[Context.DataIndex + 1] = 1.0f - TextureData[Context.DataIndex + 1];
+			});
+		}
+	}
+
 private:
 	bool bFlipGreen;
 };
@@ -0,0 +1,371 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#include "TextureSetBenchmarkCommandlet.h"
+
+#include "Dom/JsonObject.h"
+#include "Engine/Texture2D.h"
+#include "Engine/Texture2DArray.h"
+#include "FlipbookModule.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HeightModule.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PBRSurfaceModule.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "TextureSetCompiler.h"
+#include "TextureSetDefinition.h"
+#include "TextureSetsHelpers.h"
+#include "UObject/StrongObjectPtr.h"
+
+namespace TextureSetBenchmarkImpl
+{
+	struct FResult
+	{
+		FString Definition;
+		FString SourceFormat;
+		int32 Size;
+		int32 Iteration;
+		int32 PackedTextures;
+		int64 Pixels; // Generated pixels, over all packed textures
+		double PrepareSeconds;
+		double InitializeSeconds;
+		double GenerateSeconds;
+		double ParameterSeconds;
+		double TotalSeconds;
+		double MegapixelsPerSecond; // Generated pixels over generation time
+		double PeakUsedPhysicalMB; // Peak for the process so far, so only increases between results
+	};
+
+	static bool ParseSourceFormat(const FString& Name, ETextureSourceFormat& OutFormat)
+	{
+		static const TMap<FString, ETextureSourceFormat> Formats = {
+			{TEXT("G8"), TSF_G8},
+			{TEXT("BGRA8"), TSF_BGRA8},
+			{TEXT("RGBA16F"), TSF_RGBA16F},
+			{TEXT("R32F"), TSF_R32F},
+		};
+
+		const ETextureSourceFormat* Format = Formats.Find(Name.ToUpper());
+		if (Format)
+			OutFormat = *Format;
+		return Format != nullptr;
+	}
+
+	static UTextureSetDefinition* MakeDefinition(const FString& Name)
+	{
+		UTextureSetDefinition* Definition = NewObject<UTextureSetDefinition>(GetTransientPackage(), FName("Benchmark_" + Name), RF_Transient);
+
+		auto MakePackedTexture = [](TextureCompressionSettings Compression, const TArray<FName>& Sources)
+		{
+			FTextureSetPackedTextureDef PackedTexture;
+			PackedTexture.CompressionSettings = Compression;
+			for (int i = 0; i < Sources.Num(); i++)
+				PackedTexture.SetSource(i, Sources[i]);
+			return PackedTexture;
+		};
+
+		TArray<UTextureSetModule*> Modules;
+		TArray<FTextureSetPackedTextureDef> PackedTextures;
+
+		if (Name == TEXT("PBR") || Name == TEXT("Flipbook"))
+		{
+			Modules.Add(NewObject<UPBRSurfaceModule>(Definition));
+			PackedTextures.Add(MakePackedTexture(TC_Default, {"BaseColor.r", "BaseColor.g", "BaseColor.b", "Metallic.r"}));
+			PackedTextures.Add(MakePackedTexture(TC_Default, {"TangentNormal.r", "TangentNormal.g", "Roughness.r"}));
+		}
+
+		if (Name == TEXT("Flipbook"))
+		{
+			Modules.Add(NewObject<UFlipbookModule>(Definition));
+		}
+
+		if (Name == TEXT("Height"))
+		{
+			Modules.Add(NewObject<UHeightModule>(Definition));
+			PackedTextures.Add(MakePackedTexture(TC_Grayscale, {"Height.r"}));
+		}
+
+		if (Modules.IsEmpty())
+			return nullptr;
+
+		Definition->SetEdits(Modules, PackedTextures);
+		return Definition;
+	}
+
+	// Smooth gradients with some high frequency noise, different for each channel, so that no channel is constant
+	// and range compression has a real range to work with.
+	static float SyntheticValue(int32 X, int32 Y, int32 Channel, int32 Size)
+	{
+		const float U = (float)X / Size;
+		const float V = (float)Y / Size;
+		const float Wave = 0.5f + 0.4f * FMath::Sin((U * (Channel + 2) + V * (4 - Channel)) * UE_TWO_PI);
+		const uint32 Hash = HashCombine(HashCombine(GetTypeHash(X), GetTypeHash(Y)), GetTypeHash(Channel));
+		return FMath::Clamp(Wave + ((Hash & 0xFF) / 255.0f - 0.5f) * 0.1f, 0.0f, 1.0f);
+	}
+
+	static UTexture2D* MakeSourceTexture(ETextureSourceFormat Format, int32 Size)
+	{
+		UTexture2D* Texture = NewObject<UTexture2D>(GetTransientPackage(), NAME_None, RF_Transient);
+		Texture->SRGB = false;
+
+		const int32 BytesPerPixel = FTextureSource::GetBytesPerPixel(Format);
+		TArray64<uint8> Data;
+		Data.SetNumUninitialized((int64)Size * Size * BytesPerPixel);
+
+		for (int32 Y = 0; Y < Size; Y++)
+		{
+			for (int32 X = 0; X < Size; X++)
+			{
+				uint8* Pixel = Data.GetData() + ((int64)Y * Size + X) * BytesPerPixel;
+
+				switch (Format)
+				{
+				case TSF_G8:
+					Pixel[0] = (uint8)FMath::RoundToInt(SyntheticValue(X, Y, 0, Size) * 255.0f);
+					break;
+				case TSF_BGRA8:
+					for (int32 c = 0; c < 4; c++)
+						Pixel[c] = (uint8)FMath::RoundToInt(SyntheticValue(X, Y, c, Size) * 255.0f);
+					break;
+				case TSF_RGBA16F:
+					for (int32 c = 0; c < 4; c++)
+						((FFloat16*)Pixel)[c] = FFloat16(SyntheticValue(X, Y, c, Size));
+					break;
+				case TSF_R32F:
+					((float*)Pixel)[0] = SyntheticValue(X, Y, 0, Size);
+					break;
+				default:
+					unimplemented();
+				}
+			}
+		}
+
+		Texture->Source.Init(Size, Size, 1, 1, Format, Data.GetData());
+		return Texture;
+	}
+
+	static FResult RunCase(UTextureSetDefinition* Definition, const FString& DefinitionName, ETextureSourceFormat Format, const FString& FormatName, int32 Size, int32 Iteration)
+	{
+		FResult Result = {};
+		Result.Definition = DefinitionName;
+		Result.SourceFormat = FormatName;
+		Result.Size = Size;
+		Result.Iteration = Iteration;
+
+		TSharedRef<FTextureSetCompilerArgs> Args = MakeShared<FTextureSetCompilerArgs>();
+		Args->ModuleInfo = Definition->GetModuleInfo();
+		Args->PackingInfo = Definition->GetPackingInfo();
+		Args->OuterObject = GetTransientPackage();
+		Args->NamePrefix = FString::Printf(TEXT("Benchmark_%s_%s_%i_%i"), *DefinitionName, *FormatName, Size, Iteration);
+		Args->DebugContext = Args->NamePrefix;
+		Args->UserKey = FGuid::NewGuid().ToString(); // Never match anything previously generated
+
+		for (const auto& [Name, SourceDef] : Definition->GetModuleInfo().GetSourceTextures())
+		{
+			FTextureSetSourceTextureReference Reference;
+			Reference.Texture = MakeSourceTexture(Format, Size);
+			Args->SourceTextures.Add(Name, Reference);
+		}
+
+		Args->AssetParams.UpdateParamList(Definition, Definition->GetRequiredAssetParamClasses());
+
+		if (DefinitionName == TEXT("Flipbook"))
+		{
+			// Read frames out of a 4x4 sheet, so the subframe extraction is part of the measurement
+			UFlipbookAssetParams* FlipbookParams = const_cast<UFlipbookAssetParams*>(Args->AssetParams.Get<UFlipbookAssetParams>());
+			FlipbookParams->FlipbookSourceType = EFlipbookSourceType::TextureSheet;
+			FlipbookParams->FlipbookSourceSheetWidth = 4;
+			FlipbookParams->FlipbookSourceSheetHeight = 4;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		FTextureSetCompiler Compiler(Args);
+		Compiler.Prepare();
+
+		double SectionTime = FPlatformTime::Seconds();
+		Result.PrepareSeconds = SectionTime - StartTime;
+
+		const int32 NumPackedTextures = Args->PackingInfo.NumPackedTextures();
+		Result.PackedTextures = NumPackedTextures;
+
+		TArray<FDerivedTexture> DerivedTextures;
+		DerivedTextures.SetNum(NumPackedTextures);
+
+		for (int32 t = 0; t < NumPackedTextures; t++)
+		{
+			const bool bArray = Args->PackingInfo.GetPackedTextureInfo(t).Flags & (uint8)ETextureSetTextureFlags::Array;
+			DerivedTextures[t].Texture = NewObject<UTexture>(GetTransientPackage(), bArray ? UTexture2DArray::StaticClass() : UTexture2D::StaticClass(), NAME_None, RF_Transient);
+
+			Compiler.ConfigureTexture(DerivedTextures[t], t);
+			Compiler.InitializeTextureSource(DerivedTextures[t], t);
+		}
+
+		Result.InitializeSeconds = FPlatformTime::Seconds() - SectionTime;
+		SectionTime = FPlatformTime::Seconds();
+
+		for (int32 t = 0; t < NumPackedTextures; t++)
+		{
+			Compiler.GenerateTextureSource(DerivedTextures[t], t);
+
+			const FTextureSource& Source = DerivedTextures[t].Texture->Source;
+			Result.Pixels += (int64)Source.GetSizeX() * Source.GetSizeY() * Source.GetNumSlices();
+		}
+
+		Result.GenerateSeconds = FPlatformTime::Seconds() - SectionTime;
+		SectionTime = FPlatformTime::Seconds();
+
+		for (FName Name : Compiler.GetAllParameterNames())
+			Compiler.BuildParameterData(Name);
+
+		Result.ParameterSeconds = FPlatformTime::Seconds() - SectionTime;
+		Result.TotalSeconds = FPlatformTime::Seconds() - StartTime;
+		Result.MegapixelsPerSecond = Result.GenerateSeconds > 0 ? Result.Pixels / Result.GenerateSeconds / 1e6 : 0;
+		Result.PeakUsedPhysicalMB = FPlatformMemory::GetStats().PeakUsedPhysical / (1024.0 * 1024.0);
+
+		return Result;
+	}
+
+	static FString ToCSV(const TArray<FResult>& Results)
+	{
+		FString CSV = TEXT("Definition,SourceFormat,Size,Iteration,PackedTextures,Pixels,PrepareSeconds,InitializeSeconds,GenerateSeconds,ParameterSeconds,TotalSeconds,MegapixelsPerSecond,PeakUsedPhysicalMB\n");
+
+		for (const FResult& R : Results)
+		{
+			CSV += FString::Printf(TEXT("%s,%s,%i,%i,%i,%lld,%f,%f,%f,%f,%f,%f,%f\n"),
+				*R.Definition, *R.SourceFormat, R.Size, R.Iteration, R.PackedTextures, R.Pixels,
+				R.PrepareSeconds, R.InitializeSeconds, R.GenerateSeconds, R.ParameterSeconds, R.TotalSeconds, R.MegapixelsPerSecond, R.PeakUsedPhysicalMB);
+		}
+
+		return CSV;
+	}
+
+	static FString ToJSON(const TArray<FResult>& Results)
+	{
+		TArray<TSharedPtr<FJsonValue>> Rows;
+
+		for (const FResult& R : Results)
+		{
+			TSharedRef<FJsonObject> Row = MakeShared<FJsonObject>();
+			Row->SetStringField(TEXT("Definition"), R.Definition);
+			Row->SetStringField(TEXT("SourceFormat"), R.SourceFormat);
+			Row->SetNumberField(TEXT("Size"), R.Size);
+			Row->SetNumberField(TEXT("Iteration"), R.Iteration);
+			Row->SetNumberField(TEXT("PackedTextures"), R.PackedTextures);
+			Row->SetNumberField(TEXT("Pixels"), (double)R.Pixels);
+			Row->SetNumberField(TEXT("PrepareSeconds"), R.PrepareSeconds);
+			Row->SetNumberField(TEXT("InitializeSeconds"), R.InitializeSeconds);
+			Row->SetNumberField(TEXT("GenerateSeconds"), R.GenerateSeconds);
+			Row->SetNumberField(TEXT("ParameterSeconds"), R.ParameterSeconds);
+			Row->SetNumberField(TEXT("TotalSeconds"), R.TotalSeconds);
+			Row->SetNumberField(TEXT("MegapixelsPerSecond"), R.MegapixelsPerSecond);
+			Row->SetNumberField(TEXT("PeakUsedPhysicalMB"), R.PeakUsedPhysicalMB);
+			Rows.Add(MakeShared<FJsonValueObject>(Row));
+		}
+
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetArrayField(TEXT("Results"), Rows);
+
+		FString JSON;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JSON);
+		FJsonSerializer::Serialize(Root, Writer);
+		return JSON;
+	}
+}
+
+UTextureSetBenchmarkCommandlet::UTextureSetBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UTextureSetBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace TextureSetBenchmarkImpl;
+
+	FString DefinitionsParam = TEXT("PBR,Height,Flipbook");
+	FString FormatsParam = TEXT("G8,BGRA8,RGBA16F,R32F");
+	FString SizesParam = TEXT("512,1024,2048");
+	int32 Iterations = 1;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("TextureSetBenchmark") / (TEXT("Benchmark_") + FDateTime::Now().ToString());
+
+	FParse::Value(*Params, TEXT("Definitions="), DefinitionsParam);
+	FParse::Value(*Params, TEXT("Formats="), FormatsParam);
+	FParse::Value(*Params, TEXT("Sizes="), SizesParam);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<FString> DefinitionNames;
+	TArray<FString> FormatNames;
+	TArray<FString> SizeStrings;
+	DefinitionsParam.ParseIntoArray(DefinitionNames, TEXT(","));
+	FormatsParam.ParseIntoArray(FormatNames, TEXT(","));
+	SizesParam.ParseIntoArray(SizeStrings, TEXT(","));
+
+	// Measure the compiler itself, so disable everything that could fetch generated data from the DDC
+	const TCHAR* DDCCVars[] = { TEXT("ts.ChannelCache"), TEXT("ts.SourceCache") };
+	for (const TCHAR* Name : DDCCVars)
+	{
+		if (IConsoleVariable* CVar = IConsoleManager::Get().FindConsoleVariable(Name))
+			CVar->Set(false, ECVF_SetByCommandline);
+	}
+
+	TArray<FResult> Results;
+
+	for (const FString& DefinitionName : DefinitionNames)
+	{
+		// Held strongly, so only the textures of each case are collected between cases, and not the definition and its modules
+		TStrongObjectPtr<UTextureSetDefinition> Definition(MakeDefinition(DefinitionName));
+
+		if (!Definition)
+		{
+			UE_LOG(LogTextureSet, Error, TEXT("Unknown benchmark definition \"%s\", expected PBR, Height or Flipbook"), *DefinitionName);
+			return 1;
+		}
+
+		for (const FString& FormatName : FormatNames)
+		{
+			ETextureSourceFormat Format;
+			if (!ParseSourceFormat(FormatName, Format))
+			{
+				UE_LOG(LogTextureSet, Error, TEXT("Unknown benchmark source format \"%s\", expected G8, BGRA8, RGBA16F or R32F"), *FormatName);
+				return 1;
+			}
+
+			for (const FString& SizeString : SizeStrings)
+			{
+				const int32 Size = FCString::Atoi(*SizeString);
+
+				for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+				{
+					const FResult Result = RunCase(Definition.Get(), DefinitionName, Format, FormatName.ToUpper(), Size, Iteration);
+
+					UE_LOG(LogTextureSet, Display, TEXT("%s %s %ix%i #%i: %.3fs total (prepare %.3fs, initialize %.3fs, generate %.3fs, parameters %.3fs), %.2f MPix/s, peak %.0fMB"),
+						*Result.Definition, *Result.SourceFormat, Size, Size, Iteration, Result.TotalSeconds, Result.PrepareSeconds, Result.InitializeSeconds,
+						Result.GenerateSeconds, Result.ParameterSeconds, Result.MegapixelsPerSecond, Result.PeakUsedPhysicalMB);
+
+					Results.Add(Result);
+
+					// Release the textures of this case before the next one
+					CollectGarbage(RF_NoFlags);
+				}
+			}
+		}
+	}
+
+	const FString CSVPath = OutputPath + TEXT(".csv");
+	const FString JSONPath = OutputPath + TEXT(".json");
+
+	if (!FFileHelper::SaveStringToFile(ToCSV(Results), *CSVPath) || !FFileHelper::SaveStringToFile(ToJSON(Results), *JSONPath))
+	{
+		UE_LOG(LogTextureSet, Error, TEXT("Failed to write benchmark results to %s"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTextureSet, Display, TEXT("Wrote %i benchmark results to %s and %s"), Results.Num(), *CSVPath, *JSONPath);
+	return 0;
+}
@@ -0,0 +1,24 @@
+// Copyright (c) 2024 Electronic Arts. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+
+#include "TextureSetBenchmarkCommandlet.generated.h"
+
+// Compiles texture sets built from synthetic source textures over a matrix of definitions, source formats and sizes,
+// and writes the timings of each compilation stage to CSV and JSON, as a reproducible baseline for compiler changes.
+//
+// Usage: -run=TextureSetBenchmark [-Definitions=PBR,Height,Flipbook] [-Formats=G8,BGRA8,RGBA16F,R32F] [-Sizes=512,1024,2048]
+//        [-Iterations=1] [-Output=<path without extension>]
+UCLASS()
+class UTextureSetBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTextureSetBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -31,6 +31,7 @@ public class TextureSetsStandardModules : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Json",
 				"Projects",
 				"RenderCore",
 			}